@@ -0,0 +1,252 @@
+#include "analytics.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <cstring>
+
+static const char kMagic[4] = { 'E', 'G', 'G', 'A' };
+static const quint16 kVersion = 1;
+static const quint16 kColumns = 5;
+static const int kHeaderSize = 4 + 2 + 2;
+
+// ======================================================
+// EVENT CHUNK
+// ======================================================
+void EventChunk::reserve(int n)
+{
+    timeMs.reserve(n);
+    kind.reserve(n);
+    eggType.reserve(n);
+    score.reserve(n);
+    value.reserve(n);
+}
+
+void EventChunk::clear()
+{
+    timeMs.clear();
+    kind.clear();
+    eggType.clear();
+    score.clear();
+    value.clear();
+}
+
+// ======================================================
+// COLUMN ENCODING
+// ======================================================
+static void putVarint(QByteArray &out, quint32 v)
+{
+    while (v >= 0x80) {
+        out.append(char(v | 0x80));
+        v >>= 7;
+    }
+    out.append(char(v));
+}
+
+static bool getVarint(const uchar *&p, const uchar *end, quint32 &v)
+{
+    v = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uchar b = *p++;
+        v |= quint32(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static quint32 zigzag(qint32 v) { return (quint32(v) << 1) ^ quint32(v >> 31); }
+static qint32 unzigzag(quint32 v) { return qint32(v >> 1) ^ -qint32(v & 1); }
+
+template <typename T>
+static QByteArray encodeDelta(const QVector<T> &column)
+{
+    QByteArray out;
+    out.reserve(column.size() * 2);
+    qint64 prev = 0;
+    for (T v : column) {
+        putVarint(out, zigzag(qint32(qint64(v) - prev)));
+        prev = v;
+    }
+    return out;
+}
+
+template <typename T>
+static bool decodeDelta(const QByteArray &raw, int count, QVector<T> &column)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(raw.constData());
+    const uchar *end = p + raw.size();
+    column.resize(count);
+    qint64 prev = 0;
+    for (int i = 0; i < count; ++i) {
+        quint32 v;
+        if (!getVarint(p, end, v))
+            return false;
+        prev += unzigzag(v);
+        column[i] = T(prev);
+    }
+    return true;
+}
+
+template <typename T>
+static QByteArray encodeRaw(const QVector<T> &column)
+{
+    return QByteArray(reinterpret_cast<const char *>(column.constData()),
+                      column.size() * int(sizeof(T)));
+}
+
+template <typename T>
+static bool decodeRaw(const QByteArray &raw, int count, QVector<T> &column)
+{
+    if (raw.size() != count * int(sizeof(T)))
+        return false;
+    column.resize(count);
+    memcpy(column.data(), raw.constData(), raw.size());
+    return true;
+}
+
+static QByteArray encodeChunk(const EventChunk &chunk)
+{
+    const QByteArray columns[kColumns] = {
+        encodeDelta(chunk.timeMs),
+        encodeRaw(chunk.kind),
+        encodeRaw(chunk.eggType),
+        encodeDelta(chunk.score),
+        encodeRaw(chunk.value),
+    };
+
+    QByteArray out;
+    QDataStream stream(&out, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << quint32(chunk.size());
+    for (const QByteArray &col : columns) {
+        QByteArray packed = qCompress(col);
+        stream << quint32(packed.size());
+        stream.writeRawData(packed.constData(), packed.size());
+    }
+    return out;
+}
+
+// ======================================================
+// SESSION LOGGER
+// ======================================================
+SessionLogger::SessionLogger()
+{
+    writer.setMaxThreadCount(1);   // chunks must land in order
+    current.reserve(kChunkEvents);
+}
+
+SessionLogger::~SessionLogger()
+{
+    end();
+    flush();
+}
+
+void SessionLogger::begin(const QString &path)
+{
+    end();      // the old file's chunks are queued ahead of the new header
+
+    filePath = path;
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    current.clear();
+    active = true;
+
+    writer.start([path]() {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qDebug() << "FAILED TO CREATE SESSION LOG:" << path;
+            return;
+        }
+        QDataStream out(&file);
+        out.setByteOrder(QDataStream::LittleEndian);
+        out.writeRawData(kMagic, 4);
+        out << kVersion << kColumns;
+    });
+}
+
+void SessionLogger::end()
+{
+    if (!active)
+        return;
+    if (current.size() > 0)
+        flushChunk();
+    active = false;
+}
+
+void SessionLogger::flush()
+{
+    writer.waitForDone();
+}
+
+void SessionLogger::flushChunk()
+{
+    // Hand the full columns to the writer and start a fresh chunk
+    EventChunk chunk = std::move(current);
+    current = EventChunk();
+    current.reserve(kChunkEvents);
+
+    QString path = filePath;
+    writer.start([path, chunk]() {
+        QFile file(path);
+        if (!file.open(QIODevice::Append))
+            return;
+        file.write(encodeChunk(chunk));
+    });
+}
+
+// ======================================================
+// READER
+// ======================================================
+namespace Analytics {
+
+bool readChunks(const uchar *data, qint64 size,
+                const std::function<void(const EventChunk &)> &onChunk)
+{
+    if (size < kHeaderSize || memcmp(data, kMagic, 4) != 0)
+        return false;
+
+    QByteArray mapped = QByteArray::fromRawData(reinterpret_cast<const char *>(data), qsizetype(size));
+    QDataStream in(mapped);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.skipRawData(4);
+
+    quint16 version = 0, columns = 0;
+    in >> version >> columns;
+    if (version > kVersion || columns != kColumns)
+        return false;
+
+    EventChunk chunk;
+    while (!in.atEnd()) {
+        quint32 count = 0;
+        in >> count;
+        if (count > quint32(SessionLogger::kChunkEvents))
+            return false;
+
+        QByteArray cols[kColumns];
+        for (QByteArray &col : cols) {
+            quint32 packedSize = 0;
+            in >> packedSize;
+            qint64 pos = in.device()->pos();
+            if (in.status() != QDataStream::Ok || packedSize > quint64(size - pos))
+                return false;
+            // decompress straight out of the mapping
+            col = qUncompress(data + pos, qsizetype(packedSize));
+            in.skipRawData(int(packedSize));
+        }
+
+        int n = int(count);
+        if (!decodeDelta(cols[0], n, chunk.timeMs)
+            || !decodeRaw(cols[1], n, chunk.kind)
+            || !decodeRaw(cols[2], n, chunk.eggType)
+            || !decodeDelta(cols[3], n, chunk.score)
+            || !decodeRaw(cols[4], n, chunk.value))
+            return false;
+
+        onChunk(chunk);
+    }
+    return true;
+}
+
+}
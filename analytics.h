@@ -0,0 +1,97 @@
+#ifndef ANALYTICS_H
+#define ANALYTICS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <functional>
+
+// ======================================================
+// GAMEPLAY EVENTS
+// ======================================================
+enum class GameEventKind : quint8 {
+    Catch,
+    Splat,
+    LifeGained,
+    LifeLost,
+    WindStart,
+    WindEnd,
+    FocusEnter,
+    FocusExit,
+    Count
+};
+
+// One chunk of events stored column by column
+struct EventChunk {
+    QVector<quint32> timeMs;    // session time
+    QVector<quint8>  kind;      // GameEventKind
+    QVector<quint8>  eggType;   // EggType, 0 when not egg related
+    QVector<qint32>  score;     // score after the event
+    QVector<float>   value;     // kind specific (wind strength, lives, ...)
+
+    int size() const { return timeMs.size(); }
+    void reserve(int n);
+    void clear();
+};
+
+/* -------------------------------------------------------------
+   FILE LAYOUT (little endian)
+     char[4]  magic "EGGA"
+     quint16  version
+     quint16  column count
+   then chunks:
+     quint32  event count
+     per column: quint32 compressed size, qCompress()ed bytes
+   time and score are delta + zigzag varint encoded before compression.
+--------------------------------------------------------------*/
+class SessionLogger
+{
+public:
+    static constexpr int kChunkEvents = 4096;
+
+    SessionLogger();
+    ~SessionLogger();
+
+    void begin(const QString &path);
+    // Hands the last chunk to the writer and returns; flush() waits
+    void end();
+    void flush();
+    bool isActive() const { return active; }
+
+    // Hot path: appends to preallocated columns, no I/O
+    inline void log(GameEventKind kind, float time, int score,
+                    quint8 eggType = 0, float value = 0.0f)
+    {
+        if (!active)
+            return;
+        current.timeMs.append(quint32(time * 1000.0f));
+        current.kind.append(quint8(kind));
+        current.eggType.append(eggType);
+        current.score.append(score);
+        current.value.append(value);
+        if (current.size() >= kChunkEvents)
+            flushChunk();
+    }
+
+private:
+    void flushChunk();
+
+    bool active = false;
+    QString filePath;
+    EventChunk current;
+    QThreadPool writer;
+};
+
+// ======================================================
+// READING (used by the eggstats tool)
+// ======================================================
+namespace Analytics {
+
+// Walks every chunk of a mapped log, returns false on a malformed file
+bool readChunks(const uchar *data, qint64 size,
+                const std::function<void(const EventChunk &)> &onChunk);
+
+}
+
+#endif // ANALYTICS_H
@@ -0,0 +1,157 @@
+#include "assetcache.h"
+#include "eggraster.h"
+
+#include <QPainter>
+#include <QPen>
+#include <QtMath>
+
+qint64 RenderAssets::bytes() const
+{
+    qint64 total = background.sizeInBytes();
+    for (const QImage &sprite : eggSprites)
+        total += sprite.sizeInBytes();
+    return total;
+}
+
+AssetCache::AssetCache(QObject *owner, int gridSize, int gridBox, qint64 budgetBytes)
+    : owner(owner),
+    gridSize(gridSize),
+    gridBox(gridBox),
+    cache(int(qMax<qint64>(1, budgetBytes / 1024))),
+    latest(std::make_shared<std::atomic<quint64>>(0))
+{
+    worker.setMaxThreadCount(1);
+}
+
+AssetCache::~AssetCache()
+{
+    latest->store(0);        // queued builds see they are stale and skip
+    worker.clear();
+    worker.waitForDone();
+}
+
+void AssetCache::setOnReady(std::function<void(std::shared_ptr<const RenderAssets>)> callback)
+{
+    onReady = std::move(callback);
+}
+
+qreal AssetCache::dprBucket(qreal dpr)
+{
+    // Quarter steps: 1, 1.25, 1.5, ... covers the common scale factors
+    return qMax(1, qRound(dpr * 4)) / 4.0;
+}
+
+quint64 AssetCache::keyOf(int side, qreal dpr)
+{
+    return (quint64(quint32(side)) << 32) | quint32(qRound(dprBucket(dpr) * 4));
+}
+
+void AssetCache::store(const Entry &assets)
+{
+    int costKb = int(qMax<qint64>(1, assets->bytes() / 1024));
+    cache.insert(keyOf(assets->side, assets->dpr), new Entry(assets), costKb);
+}
+
+/* -------------------------------------------------------------
+   REQUEST: hit -> assets, miss -> queue one build and return null.
+   Only the newest requested size is built; a drag-resize that
+   passes through many sizes ends up building the last one.
+--------------------------------------------------------------*/
+std::shared_ptr<const RenderAssets> AssetCache::request(int side, qreal dpr)
+{
+    quint64 key = keyOf(side, dpr);
+    if (Entry *hit = cache.object(key))
+        return *hit;
+
+    if (wanted == key)
+        return nullptr;          // already queued
+    wanted = key;
+    latest->store(key);
+
+    qreal bucket = dprBucket(dpr);
+    int grid = gridSize;
+    int box = gridBox;
+    auto stillWanted = latest;
+    QObject *context = owner;
+
+    worker.start([this, key, side, bucket, grid, box, stillWanted, context]() {
+        if (stillWanted->load() != key)
+            return;
+
+        Entry assets = build(side, bucket, grid, box);
+        QMetaObject::invokeMethod(context, [this, key, assets]() {
+            store(assets);
+            if (wanted == key)
+                wanted = 0;
+            if (onReady)
+                onReady(assets);
+        }, Qt::QueuedConnection);
+    });
+    return nullptr;
+}
+
+std::shared_ptr<const RenderAssets> AssetCache::buildNow(int side, qreal dpr)
+{
+    quint64 key = keyOf(side, dpr);
+    if (Entry *hit = cache.object(key))
+        return *hit;
+
+    Entry assets = build(side, dprBucket(dpr), gridSize, gridBox);
+    store(assets);
+    return assets;
+}
+
+/* -------------------------------------------------------------
+   BUILD (worker thread): QImage + QPainter only
+--------------------------------------------------------------*/
+std::shared_ptr<RenderAssets> AssetCache::build(int side, qreal dpr, int gridSize, int gridBox)
+{
+    auto assets = std::make_shared<RenderAssets>();
+    assets->side = side;
+    assets->dpr = dpr;
+
+    // Logical playfield units -> physical pixels
+    const qreal pixelScale = side * dpr / gridSize;
+    const int physical = qCeil(side * dpr);
+    const int cols = qMax(40, gridSize / gridBox);
+    const int rows = qMax(30, gridSize / gridBox);
+
+    // ---- Background: green field with the cell grid ----
+    assets->background = QImage(physical, physical, QImage::Format_ARGB32_Premultiplied);
+    assets->background.fill(QColor(48, 120, 48));
+    {
+        QPainter g(&assets->background);
+        g.scale(pixelScale, pixelScale);
+        g.setPen(QPen(QColor(25, 100, 25, 80), 1));
+        for (int i = 0; i <= cols; ++i)
+            g.drawLine(i * gridBox, 0, i * gridBox, gridSize);
+        for (int j = 0; j <= rows; ++j)
+            g.drawLine(0, j * gridBox, gridSize, j * gridBox);
+    }
+    assets->background.setDevicePixelRatio(dpr);
+
+    // ---- Falling egg sprites, same pixels as the per-frame plotter ----
+    const float w = gridBox * 2.5f * 1.5f;
+    const float h = gridBox * 2.5f * 2.0f;
+    const int halfW = qCeil(w * 0.55f) + 1;
+    const int halfH = qCeil(h * 0.5f) + 1;
+    assets->eggSpriteRect = QRect(-halfW, -halfH, 2 * halfW + 1, 2 * halfH + 1);
+
+    for (int t = 0; t < int(EggType::Count); ++t) {
+        QImage sprite(qCeil(assets->eggSpriteRect.width() * pixelScale),
+                      qCeil(assets->eggSpriteRect.height() * pixelScale),
+                      QImage::Format_ARGB32_Premultiplied);
+        sprite.fill(Qt::transparent);
+
+        QPainter sp(&sprite);
+        sp.scale(pixelScale, pixelScale);
+        sp.translate(-assets->eggSpriteRect.topLeft());
+        EggRaster::paintPixelEgg(sp, QPointF(0, 0), w, h,
+                                 QColor::fromRgba(eggTraits(EggType(t)).tint), Qt::yellow);
+        sp.end();
+
+        assets->eggSprites[t] = sprite;
+    }
+
+    return assets;
+}
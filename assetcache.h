@@ -0,0 +1,71 @@
+#ifndef ASSETCACHE_H
+#define ASSETCACHE_H
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QRect>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "eggtraits.h"
+
+// Everything that depends on the on-screen size of the playfield
+struct RenderAssets {
+    int side = 0;            // playfield side in device-independent pixels
+    qreal dpr = 1.0;         // device pixel ratio bucket it was built for
+    QImage background;       // side * dpr square, devicePixelRatio set
+    QImage eggSprites[int(EggType::Count)];   // falling eggs at full size
+    QRect eggSpriteRect;     // logical units, relative to the egg's pixel origin
+
+    qint64 bytes() const;
+};
+
+// ======================================================
+// Size/DPR-keyed cache of RenderAssets.
+//
+// Builds run on one worker thread (QImage only, no QPixmap), the
+// result is handed to the GUI thread through a queued call and
+// swapped in whole between frames. Built sets live in an LRU
+// bounded by bytes, so bouncing between sizes or screens reuses
+// them without growing without limit.
+// ======================================================
+class AssetCache
+{
+public:
+    static constexpr qint64 kDefaultBudget = 96 * 1024 * 1024;
+
+    // gridSize/gridBox describe the logical playfield the assets draw
+    AssetCache(QObject *owner, int gridSize, int gridBox, qint64 budgetBytes = kDefaultBudget);
+    ~AssetCache();
+
+    // Cached assets for this size, or null after queueing a build.
+    // onReady runs on the owner's thread once a queued build lands.
+    std::shared_ptr<const RenderAssets> request(int side, qreal dpr);
+    void setOnReady(std::function<void(std::shared_ptr<const RenderAssets>)> callback);
+
+    // Synchronous build, used once at startup before the first frame
+    std::shared_ptr<const RenderAssets> buildNow(int side, qreal dpr);
+
+    static qreal dprBucket(qreal dpr);
+
+private:
+    using Entry = std::shared_ptr<const RenderAssets>;
+
+    static quint64 keyOf(int side, qreal dpr);
+    static std::shared_ptr<RenderAssets> build(int side, qreal dpr, int gridSize, int gridBox);
+    void store(const Entry &assets);
+
+    QObject *owner;
+    int gridSize;
+    int gridBox;
+    QCache<quint64, Entry> cache;     // cost in KB
+    quint64 wanted = 0;               // latest requested key, older builds are dropped
+    std::shared_ptr<std::atomic<quint64>> latest;   // shared with queued jobs
+    std::function<void(Entry)> onReady;
+    QThreadPool worker;
+};
+
+#endif // ASSETCACHE_H
@@ -0,0 +1,325 @@
+#include "audioengine.h"
+
+#include <QAudioDevice>
+#include <QAudioSink>
+#include <QDebug>
+#include <QFile>
+#include <QIODevice>
+#include <QMediaDevices>
+#include <QResource>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+/* -------------------------------------------------------------
+   COMMAND RING
+--------------------------------------------------------------*/
+bool AudioCommandQueue::push(const AudioCommand &cmd)
+{
+    quint32 t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) >= quint32(kCapacity))
+        return false;
+    ring[t & (kCapacity - 1)] = cmd;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+bool AudioCommandQueue::pop(AudioCommand &out)
+{
+    quint32 h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire))
+        return false;
+    out = ring[h & (kCapacity - 1)];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+// ======================================================
+// MIXER (audio thread)
+// ======================================================
+class AudioMixerDevice : public QIODevice
+{
+public:
+    AudioMixerDevice(AudioCommandQueue &commands,
+                     const std::array<std::atomic<const AudioClip *>, int(Sfx::Count)> &clips,
+                     const std::atomic<float> &masterVolume,
+                     int outputRate)
+        : commands(commands),
+        clips(clips),
+        masterVolume(masterVolume),
+        // Clips are stored at kSampleRate, step through them at the device rate
+        step(quint32((quint64(AudioEngine::kSampleRate) << 16) / quint32(outputRate)))
+    {
+    }
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override
+    {
+        return std::numeric_limits<int>::max() + QIODevice::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    struct Voice {
+        const AudioClip *clip = nullptr;
+        quint64 pos = 0;        // 16.16 frames
+        float gainL = 0.0f;
+        float gainR = 0.0f;
+        quint32 startedAt = 0;
+    };
+
+    void startVoice(const AudioCommand &cmd);
+
+    AudioCommandQueue &commands;
+    const std::array<std::atomic<const AudioClip *>, int(Sfx::Count)> &clips;
+    const std::atomic<float> &masterVolume;
+    const quint32 step;
+
+    std::array<Voice, AudioEngine::kVoices> voices;
+    quint32 voiceClock = 0;
+    std::vector<float> mix;
+};
+
+void AudioMixerDevice::startVoice(const AudioCommand &cmd)
+{
+    const AudioClip *clip = clips[int(cmd.sfx)].load(std::memory_order_acquire);
+    if (!clip || clip->frames() == 0)
+        return;
+
+    // Free voice, otherwise steal the oldest one
+    Voice *target = &voices[0];
+    for (Voice &v : voices) {
+        if (!v.clip) {
+            target = &v;
+            break;
+        }
+        if (v.startedAt < target->startedAt)
+            target = &v;
+    }
+
+    float pan = std::clamp(cmd.pan, -1.0f, 1.0f);
+    target->clip = clip;
+    target->pos = 0;
+    target->gainL = cmd.gain * std::min(1.0f, 1.0f - pan);
+    target->gainR = cmd.gain * std::min(1.0f, 1.0f + pan);
+    target->startedAt = ++voiceClock;
+}
+
+qint64 AudioMixerDevice::readData(char *data, qint64 maxlen)
+{
+    const qint64 frames = maxlen / 4;   // stereo int16
+    if (frames <= 0)
+        return 0;
+
+    AudioCommand cmd;
+    while (commands.pop(cmd))
+        startVoice(cmd);
+
+    mix.assign(size_t(frames) * 2, 0.0f);   // capacity is kept between calls
+
+    for (Voice &v : voices) {
+        if (!v.clip)
+            continue;
+
+        const qint16 *src = v.clip->samples.constData();
+        const quint64 end = quint64(v.clip->frames()) << 16;
+        for (qint64 i = 0; i < frames; ++i) {
+            if (v.pos >= end) {
+                v.clip = nullptr;
+                break;
+            }
+            qint64 idx = qint64(v.pos >> 16) * 2;
+            mix[size_t(i) * 2] += src[idx] * v.gainL;
+            mix[size_t(i) * 2 + 1] += src[idx + 1] * v.gainR;
+            v.pos += step;
+        }
+    }
+
+    const float master = masterVolume.load(std::memory_order_relaxed);
+    qint16 *out = reinterpret_cast<qint16 *>(data);
+    for (qint64 i = 0; i < frames * 2; ++i)
+        out[i] = qint16(std::clamp(mix[size_t(i)] * master, -32768.0f, 32767.0f));
+
+    return frames * 4;
+}
+
+// ======================================================
+// ENGINE (game thread)
+// ======================================================
+AudioEngine::AudioEngine()
+{
+    for (auto &c : clips)
+        c.store(nullptr);
+}
+
+AudioEngine::~AudioEngine()
+{
+    if (started) {
+        QMetaObject::invokeMethod(sinkOwner, [this]() {
+            for (QAudioSink *sink : sinkOwner->findChildren<QAudioSink *>())
+                sink->stop();
+            sinkOwner->deleteLater();    // runs as the thread finishes
+        }, Qt::BlockingQueuedConnection);
+        thread.quit();
+        thread.wait();
+    }
+    qDeleteAll(owned);
+}
+
+void AudioEngine::start()
+{
+    if (started)
+        return;
+
+    QAudioDevice device = QMediaDevices::defaultAudioOutput();
+    QAudioFormat format;
+    format.setSampleRate(kSampleRate);
+    format.setChannelCount(2);
+    format.setSampleFormat(QAudioFormat::Int16);
+    if (!device.isFormatSupported(format))
+        format.setSampleRate(device.preferredFormat().sampleRate());
+    if (device.isNull() || !device.isFormatSupported(format)) {
+        qDebug() << "NO USABLE AUDIO OUTPUT";
+        return;
+    }
+
+    started = true;
+    thread.setObjectName("audio");
+    thread.start(QThread::TimeCriticalPriority);
+
+    sinkOwner = new QObject;
+    sinkOwner->moveToThread(&thread);
+    QMetaObject::invokeMethod(sinkOwner, [this, device, format]() {
+        mixer = new AudioMixerDevice(commands, clips, masterVolume, format.sampleRate());
+        mixer->setParent(sinkOwner);
+        mixer->open(QIODevice::ReadOnly);
+
+        auto *sink = new QAudioSink(device, format, sinkOwner);
+        // Small device buffer: this is what keeps event-to-speaker short.
+        // Backends may round it up to their own minimum.
+        sink->setBufferSize(format.bytesForDuration(kBufferMs * 1000));
+        sink->start(mixer);
+    }, Qt::QueuedConnection);
+}
+
+void AudioEngine::play(Sfx sfx, float gain, float pan)
+{
+    if (started)
+        commands.push({ sfx, gain, pan });
+}
+
+void AudioEngine::setMasterVolume(float volume)
+{
+    masterVolume.store(std::clamp(volume, 0.0f, 1.0f), std::memory_order_relaxed);
+}
+
+bool AudioEngine::loadFile(Sfx sfx, const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "FAILED TO OPEN SOUND:" << path;
+        return false;
+    }
+    return load(sfx, file.readAll());
+}
+
+bool AudioEngine::load(Sfx sfx, const QByteArray &wav)
+{
+    AudioClip clip;
+    if (!decodeWav(wav, kSampleRate, clip)) {
+        qDebug() << "UNSUPPORTED SOUND FORMAT FOR SFX" << int(sfx);
+        return false;
+    }
+    install(sfx, std::move(clip));
+    return true;
+}
+
+void AudioEngine::install(Sfx sfx, AudioClip &&clip)
+{
+    auto *ownedClip = new AudioClip(std::move(clip));
+    owned.append(ownedClip);
+    clips[int(sfx)].store(ownedClip, std::memory_order_release);
+}
+
+bool AudioEngine::decodeResource(const QString &path, AudioClip &out)
+{
+    QResource res(path);
+    if (!res.isValid()) {
+        qDebug() << "MISSING SOUND RESOURCE:" << path;
+        return false;
+    }
+
+    QByteArray wav = res.compressionAlgorithm() == QResource::NoCompression
+                         ? QByteArray::fromRawData(reinterpret_cast<const char *>(res.data()),
+                                                   qsizetype(res.size()))
+                         : res.uncompressedData();
+    return decodeWav(wav, kSampleRate, out);
+}
+
+/* -------------------------------------------------------------
+   WAV: RIFF chunks, PCM 8/16-bit or IEEE float 32-bit. Output is
+   stereo int16 at outRate (linear resampling, once at load).
+--------------------------------------------------------------*/
+bool AudioEngine::decodeWav(const QByteArray &wav, int outRate, AudioClip &out)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(wav.constData());
+    const qint64 size = wav.size();
+    if (size < 12 || memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0)
+        return false;
+
+    int format = 0, channels = 0, rate = 0, bits = 0;
+    const uchar *pcm = nullptr;
+    qint64 pcmBytes = 0;
+
+    for (qint64 off = 12; off + 8 <= size;) {
+        quint32 len = qFromLittleEndian<quint32>(p + off + 4);
+        const uchar *body = p + off + 8;
+        qint64 avail = qMin<qint64>(len, size - off - 8);
+
+        if (memcmp(p + off, "fmt ", 4) == 0 && avail >= 16) {
+            format = qFromLittleEndian<quint16>(body);
+            channels = qFromLittleEndian<quint16>(body + 2);
+            rate = int(qFromLittleEndian<quint32>(body + 4));
+            bits = qFromLittleEndian<quint16>(body + 14);
+            if (format == 0xFFFE && avail >= 26)      // WAVE_FORMAT_EXTENSIBLE
+                format = qFromLittleEndian<quint16>(body + 24);
+        } else if (memcmp(p + off, "data", 4) == 0) {
+            pcm = body;
+            pcmBytes = avail;
+        }
+        off += 8 + qint64(len) + (len & 1);
+    }
+
+    bool ok = pcm && channels > 0 && rate > 0
+              && ((format == 1 && (bits == 8 || bits == 16)) || (format == 3 && bits == 32));
+    if (!ok)
+        return false;
+
+    const int bytesPerSample = bits / 8;
+    const qint64 inFrames = pcmBytes / (bytesPerSample * channels);
+    auto sampleAt = [&](qint64 frame, int ch) -> float {
+        const uchar *s = pcm + (frame * channels + qMin(ch, channels - 1)) * bytesPerSample;
+        if (bits == 8)  return (int(*s) - 128) * 256.0f;
+        if (bits == 16) return qFromLittleEndian<qint16>(s);
+        return qFromLittleEndian<float>(s) * 32767.0f;
+    };
+
+    const qint64 outFrames = inFrames * outRate / rate;
+    out.samples.resize(outFrames * 2);
+    for (qint64 i = 0; i < outFrames; ++i) {
+        double src = double(i) * rate / outRate;
+        qint64 a = qint64(src);
+        qint64 b = qMin(a + 1, inFrames - 1);
+        float t = float(src - a);
+        for (int ch = 0; ch < 2; ++ch) {
+            float v = sampleAt(a, ch) * (1.0f - t) + sampleAt(b, ch) * t;
+            out.samples[i * 2 + ch] = qint16(std::clamp(v, -32768.0f, 32767.0f));
+        }
+    }
+    return true;
+}
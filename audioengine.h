@@ -0,0 +1,90 @@
+#ifndef AUDIOENGINE_H
+#define AUDIOENGINE_H
+
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <array>
+#include <atomic>
+
+enum class Sfx : quint8 { Catch, Splat, Wind, Count };
+
+// Decoded, resampled clip in the engine's output format
+struct AudioClip {
+    QVector<qint16> samples;    // interleaved stereo
+    qint64 frames() const { return samples.size() / 2; }
+};
+
+/* -------------------------------------------------------------
+   Single-producer / single-consumer command ring. The game loop
+   pushes, the audio thread pops; neither side ever waits.
+--------------------------------------------------------------*/
+struct AudioCommand {
+    Sfx sfx;
+    float gain;
+    float pan;      // -1 left .. +1 right
+};
+
+class AudioCommandQueue
+{
+public:
+    static constexpr int kCapacity = 64;   // power of two
+
+    bool push(const AudioCommand &cmd);    // false when full (command dropped)
+    bool pop(AudioCommand &out);
+
+private:
+    std::array<AudioCommand, kCapacity> ring;
+    alignas(64) std::atomic<quint32> head{0};   // written by the consumer
+    alignas(64) std::atomic<quint32> tail{0};   // written by the producer
+};
+
+class AudioMixerDevice;
+
+// ======================================================
+// Small sound engine.
+//
+// Clips are decoded from WAV into memory once. A QAudioSink in pull
+// mode runs on its own time-critical thread with a ~5 ms buffer and
+// mixes a fixed pool of voices straight into the device buffer, so
+// overlapping catches just take another voice. play() only pushes a
+// command into a lock-free ring and returns.
+// ======================================================
+class AudioEngine
+{
+public:
+    static constexpr int kVoices = 16;
+    static constexpr int kSampleRate = 48000;
+    static constexpr int kBufferMs = 5;
+
+    AudioEngine();
+    ~AudioEngine();
+
+    // Decodes a PCM WAV (8/16-bit int or 32-bit float, any rate/channels)
+    bool load(Sfx sfx, const QByteArray &wav);
+    bool loadFile(Sfx sfx, const QString &path);
+    // Swaps in an already decoded clip (decode may run on any thread)
+    void install(Sfx sfx, AudioClip &&clip);
+
+    void start();
+    void play(Sfx sfx, float gain = 1.0f, float pan = 0.0f);
+    void setMasterVolume(float volume);
+
+    static bool decodeWav(const QByteArray &wav, int outRate, AudioClip &out);
+    // Decodes a WAV from Qt resources, in place when stored uncompressed
+    static bool decodeResource(const QString &path, AudioClip &out);
+
+private:
+    QThread thread;
+    AudioMixerDevice *mixer = nullptr;       // lives on `thread`
+    QObject *sinkOwner = nullptr;            // lives on `thread`
+    AudioCommandQueue commands;
+    std::array<std::atomic<const AudioClip *>, int(Sfx::Count)> clips;
+    QVector<AudioClip *> owned;              // replaced clips stay alive until shutdown
+    std::atomic<float> masterVolume{1.0f};
+    bool started = false;
+};
+
+#endif // AUDIOENGINE_H
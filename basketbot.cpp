@@ -0,0 +1,180 @@
+#include "basketbot.h"
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Catch box as in GameSimulation::updateEggs: 16 wide, an egg
+// is in once its 1-cell body reaches half a cell above the basket
+static const float kBasketHalf = 8.0f;
+static const float kCatchAbove = 1.5f;
+// How far off centre an egg can land and still be caught
+static const float kCatchSlack = 6.0f;
+
+// Landing time and column of every egg. Written to vectorise: the
+// arrays cannot alias, every value is loaded once into a local (no
+// std::min over array elements, which picks between addresses), and
+// both branches are always computed. CMakeLists.txt builds this file
+// without errno or trapping maths so sqrt and the division-fed select
+// do not stop the vectoriser; eggbench bots reports the plan cost.
+static void predict(int n, const float *__restrict px, const float *__restrict pd,
+                    const float *__restrict pv, const float *__restrict pg,
+                    const float *__restrict pc, const float *__restrict pw,
+                    const float *__restrict pl, const float *__restrict pm,
+                    float *__restrict lt, float *__restrict lx)
+{
+    for (int i = 0; i < n; ++i) {
+        const float g = pg[i];
+        const float cap = pc[i];
+        const float vy = pv[i], dist = pd[i], x = px[i], wind = pw[i], windLeft = pl[i], maxX = pm[i];
+        const float v0 = std::min(vy, cap);
+        const float d = std::max(dist, 0.0f);
+        const float tCap = std::max((cap - v0) / g, 0.0f);       // until the speed cap
+        const float dCap = v0 * tCap + 0.5f * g * tCap * tCap;
+        const float tFree = (std::sqrt(v0 * v0 + 2.0f * g * d) - v0) / g;
+        const float tCapped = tCap + (d - dCap) / cap;
+        const float t = d <= dCap ? tFree : tCapped;
+        lt[i] = t;
+        lx[i] = std::min(std::max(x + wind * std::min(t, windLeft), 0.0f), maxX) + 0.5f;
+    }
+}
+
+void InterceptPlanner::plan(GameSimulation *const *sims, int count)
+{
+    // ---------- GATHER: every falling egg, flat ----------
+    for (auto *v : { &x, &dist, &vy, &gravity, &maxFall, &wind, &windLeft, &maxX })
+        v->clear();
+    value.clear();
+    firstEgg.resize(count + 1);
+
+    for (int s = 0; s < count; ++s) {
+        const GameSimulation &sim = *sims[s];
+        firstEgg[s] = int(x.size());
+        if (sim.isOver())
+            continue;
+
+        const bool focus = sim.focusMode;
+        const float baseGravity = (10.0f + sim.score * 0.05f)
+            * (focus ? ModeTraits<true>::gravityScale : ModeTraits<false>::gravityScale);
+        const float cap = 22.0f * (focus ? ModeTraits<true>::fallSpeedScale : ModeTraits<false>::fallSpeedScale);
+        const float row = float(sim.basket.y()) - kCatchAbove;
+        const float gust = sim.windActive ? sim.windStrength : 0.0f;
+        const float gustLeft = sim.windActive ? sim.windTimer : 0.0f;
+
+        for (const Egg &egg : sim.eggs) {
+            if (egg.state != EggState::Falling)
+                continue;
+            const EggTraits &traits = eggTraits(egg.type);
+            x.push_back(float(egg.pos.x()));
+            dist.push_back(row - float(egg.pos.y()));
+            vy.push_back(egg.yVelocity);
+            gravity.push_back(baseGravity * traits.gravityScale);
+            maxFall.push_back(cap);
+            wind.push_back(gust);
+            windLeft.push_back(gustLeft);
+            maxX.push_back(float(sim.cols - 1));
+            value.push_back(traits.catchLives < 0 ? -1 : 1);
+        }
+    }
+    firstEgg[count] = int(x.size());
+
+    // ---------- PREDICT: straight-line math, one pass ----------
+    const int n = int(x.size());
+    landX.resize(n);
+    landT.resize(n);
+    const float *pd = dist.data();
+    float *lx = landX.data(), *lt = landT.data();
+    predict(n, x.data(), pd, vy.data(), gravity.data(), maxFall.data(), wind.data(), windLeft.data(),
+            maxX.data(), lt, lx);
+
+    // ---------- CHOOSE: per simulation ----------
+    const float never = std::numeric_limits<float>::max();
+    for (int s = 0; s < count; ++s) {
+        GameSimulation &sim = *sims[s];
+        if (sim.isOver())
+            continue;
+
+        const float bx = float(sim.basket.x());
+        float bestT = never;
+        float goal = sim.cols * 0.5f;       // nothing to do: wait mid-field
+        float dangerT = never;
+        float danger = 0.0f;
+
+        for (int i = firstEgg[s]; i < firstEgg[s + 1]; ++i) {
+            if (pd[i] < 0.0f)
+                continue;                   // already past the rim
+            const float off = std::abs(lx[i] - bx);
+            if (value[i] > 0) {
+                if (off - kCatchSlack <= sim.basketMaxVel * lt[i] && lt[i] < bestT) {
+                    bestT = lt[i];
+                    goal = lx[i];
+                }
+            } else if (off < kBasketHalf + 1.0f && lt[i] < dangerT) {
+                dangerT = lt[i];
+                danger = lx[i];
+            }
+        }
+
+        // A bad egg about to land in the basket wins over a far catch
+        if (dangerT < bestT) {
+            const float maxX = float(sim.cols - 1);
+            float side = bx >= danger ? 1.0f : -1.0f;
+            if (danger + side * (kBasketHalf + 2.0f) > maxX || danger + side * (kBasketHalf + 2.0f) < 0.0f)
+                side = -side;
+            goal = danger + side * (kBasketHalf + 2.0f);
+        }
+
+        sim.steer = SteerState();
+        sim.steer.setPointer(std::clamp(goal, 0.0f, float(sim.cols - 1)));
+    }
+}
+
+/* -------------------------------------------------------------
+   Cadence
+--------------------------------------------------------------*/
+BotCadence::Field BotCadence::fieldOf(const GameSimulation &sim)
+{
+    Field field;
+    field.column = sim.currentColumnIndex;
+    field.falling = int(std::count_if(sim.eggs.begin(), sim.eggs.end(),
+                                      [](const Egg &egg) { return egg.state == EggState::Falling; }));
+    field.score = sim.score;
+    field.lives = sim.lives;
+    field.wind = sim.windActive;
+    return field;
+}
+
+/* -------------------------------------------------------------
+   One simulation
+--------------------------------------------------------------*/
+void InterceptBot::moveBasket(GameSimulation &sim, float dt)
+{
+    if (cadence.due(sim)) {
+        GameSimulation *one = &sim;
+        planner.plan(&one, 1);
+        cadence.decided(sim);
+    }
+    sim.integrateBasket(dt);
+}
+
+/* -------------------------------------------------------------
+   Batch
+--------------------------------------------------------------*/
+void BotBatch::step(float dt)
+{
+    QElapsedTimer timer;
+    timer.start();
+    deciding.clear();
+    for (size_t i = 0; i < sims.size(); ++i) {
+        if (cadences[i].due(*sims[i])) {
+            cadences[i].decided(*sims[i]);
+            deciding.push_back(sims[i]);
+        }
+    }
+    planner.plan(deciding.data(), int(deciding.size()));
+    planTotalNs += timer.nsecsElapsed();
+
+    for (GameSimulation *sim : sims)
+        sim->step(dt);
+}
@@ -0,0 +1,122 @@
+#ifndef BASKETBOT_H
+#define BASKETBOT_H
+
+#include <QtGlobal>
+#include <vector>
+
+#include "gamesim.h"
+
+// ======================================================
+// Intercept bot for balancing runs and soak tests
+//
+// Every falling egg's arrival at the basket row is predicted
+// in closed form from its yVelocity, its gravity (up to the
+// fall speed cap, then constant speed) and the wind for what is
+// left of the gust. The basket is sent to the soonest good egg
+// it can still reach, or out from under a bad one.
+//
+// The prediction runs over flat float arrays with no branches,
+// so the compiler vectorises one pass over every egg; a batch
+// fills the arrays from many simulations and pays for one pass.
+// ======================================================
+class InterceptPlanner
+{
+public:
+    // Sets each simulation's steer, held until it decides again
+    void plan(GameSimulation *const *sims, int count);
+
+private:
+    // One entry per falling egg, gathered from every simulation
+    std::vector<float> x, dist, vy, gravity, maxFall, wind, windLeft, maxX;
+    std::vector<float> landX, landT;
+    std::vector<qint8> value;       // +1 worth catching, -1 costs a life
+    std::vector<int> firstEgg;      // per simulation, into the arrays
+};
+
+// When a bot decides again: as soon as the field changes (a drop
+// comes due, an egg is caught or splats, a life goes, a gust
+// starts or ends) and otherwise every kSteps. Eggs fading out
+// do not count, since coasting removes them. Counted in the simulation's steps, so
+// the steps FastForward coasts through count too.
+class BotCadence
+{
+public:
+    static constexpr quint32 kSteps = 30;    // 0.25 s
+
+    bool due(const GameSimulation &sim) const
+    {
+        return sim.stepCount - decidedAt >= kSteps || !(fieldOf(sim) == seen);
+    }
+    void decided(const GameSimulation &sim)
+    {
+        decidedAt = sim.stepCount;
+        seen = fieldOf(sim);
+    }
+    // Steps after this one it holds for, if the field stays as it is
+    int holdSteps(const GameSimulation &sim) const
+    {
+        const quint32 since = sim.stepCount - decidedAt;
+        return since >= kSteps - 1 || !(fieldOf(sim) == seen) ? 0 : int(kSteps - 1 - since);
+    }
+
+private:
+    struct Field {
+        int column = -1;
+        int falling = 0;
+        int score = 0;
+        int lives = 0;
+        bool wind = false;
+        bool operator==(const Field &o) const
+        {
+            return column == o.column && falling == o.falling && score == o.score
+                && lives == o.lives && wind == o.wind;
+        }
+    };
+    static Field fieldOf(const GameSimulation &sim);
+
+    quint32 decidedAt = 0;
+    Field seen;
+};
+
+// Plays one simulation on its own
+class InterceptBot : public BasketController
+{
+public:
+    void moveBasket(GameSimulation &sim, float dt) override;
+    int holdSteps(const GameSimulation &sim) const override { return cadence.holdSteps(sim); }
+
+private:
+    InterceptPlanner planner;
+    BotCadence cadence;
+};
+
+// Plays many simulations, deciding for all that are due in one
+// pass. The simulations must not have a controller of their own.
+class BotBatch
+{
+public:
+    void add(GameSimulation *sim)
+    {
+        sims.push_back(sim);
+        cadences.emplace_back();
+    }
+    void clear()
+    {
+        sims.clear();
+        cadences.clear();
+    }
+    int size() const { return int(sims.size()); }
+
+    // Decides for the simulations that are due, then steps each once
+    void step(float dt);
+    qint64 planNs() const { return planTotalNs; }
+
+private:
+    std::vector<GameSimulation *> sims;
+    std::vector<BotCadence> cadences;
+    std::vector<GameSimulation *> deciding;
+    InterceptPlanner planner;
+    qint64 planTotalNs = 0;
+};
+
+#endif // BASKETBOT_H
@@ -0,0 +1,159 @@
+#include "broadcast.h"
+#include "simsnapshot.h"
+
+#include <QDebug>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <algorithm>
+#include <cstring>
+
+static const int kMessageHeader = 4 + 1 + 4;
+enum : quint8 { kWhole = 0, kDelta = 1 };
+
+static QByteArray message(quint8 kind, quint32 sequence, const QByteArray &payload)
+{
+    QByteArray out(kMessageHeader + payload.size(), Qt::Uninitialized);
+    char *w = out.data();
+    const quint32 size = quint32(payload.size());
+    std::memcpy(w, &size, 4);
+    w[4] = char(kind);
+    std::memcpy(w + 5, &sequence, 4);
+    std::memcpy(w + kMessageHeader, payload.constData(), payload.size());
+    return out;
+}
+
+/* -------------------------------------------------------------
+   Publisher
+--------------------------------------------------------------*/
+BroadcastServer::BroadcastServer(quint16 port, QObject *owner)
+{
+    server = new QTcpServer(owner);
+    QObject::connect(server, &QTcpServer::newConnection, server, [this]() { accept(); });
+    if (!server->listen(QHostAddress::LocalHost, port))
+        qDebug() << "BROADCAST: CANNOT LISTEN on" << port << server->errorString();
+}
+
+BroadcastServer::~BroadcastServer()
+{
+    delete server;      // and the viewer sockets, its children
+}
+
+bool BroadcastServer::isListening() const
+{
+    return server->isListening();
+}
+
+quint16 BroadcastServer::port() const
+{
+    return server->serverPort();
+}
+
+void BroadcastServer::accept()
+{
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        viewerList.push_back({ socket, true });
+    }
+}
+
+void BroadcastServer::publish(const GameSimulation &sim)
+{
+    // Viewers that left
+    viewerList.erase(std::remove_if(viewerList.begin(), viewerList.end(), [](const Viewer &v) {
+                         if (v.socket->state() == QAbstractSocket::ConnectedState)
+                             return false;
+                         v.socket->deleteLater();
+                         return true;
+                     }),
+                     viewerList.end());
+
+    SimSnapshot::save(sim, current);
+    ++sequence;
+
+    // One message for everyone, plus one whole snapshot shared by
+    // whoever needs catching up
+    QByteArray shared;
+    QByteArray whole;
+    if (previous.isEmpty() || sequence % kKeyframeEvery == 0) {
+        shared = message(kWhole, sequence, current);
+        whole = shared;
+    } else {
+        SimSnapshot::encodeDelta(previous, current, delta);
+        shared = message(kDelta, sequence, delta);
+    }
+
+    for (Viewer &v : viewerList) {
+        if (v.socket->bytesToWrite() > kMaxBacklog) {
+            v.needsWhole = true;      // skipped: the next delta would not apply
+            continue;
+        }
+        if (v.needsWhole && whole.isEmpty())
+            whole = message(kWhole, sequence, current);
+        v.socket->write(v.needsWhole ? whole : shared);
+        v.needsWhole = false;
+    }
+
+    previous.swap(current);
+}
+
+/* -------------------------------------------------------------
+   Viewer
+--------------------------------------------------------------*/
+BroadcastViewer::BroadcastViewer(const QString &host, quint16 port, QObject *owner)
+{
+    socket = new QTcpSocket(owner);
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    socket->connectToHost(host, port);
+}
+
+BroadcastViewer::~BroadcastViewer()
+{
+    delete socket;
+}
+
+bool BroadcastViewer::isConnected() const
+{
+    return socket->state() == QAbstractSocket::ConnectedState;
+}
+
+bool BroadcastViewer::update(GameSimulation &sim)
+{
+    if (socket->bytesAvailable() > 0)
+        pending.append(socket->readAll());
+
+    bool changed = false;
+    int offset = 0;
+    while (pending.size() - offset >= kMessageHeader) {
+        const char *r = pending.constData() + offset;
+        quint32 size;
+        quint32 sequence;
+        std::memcpy(&size, r, 4);
+        std::memcpy(&sequence, r + 5, 4);
+        const quint8 kind = quint8(r[4]);
+        if (pending.size() - offset - kMessageHeader < qint64(size))
+            break;
+
+        // Own buffer: the delta is read a word at a time
+        const QByteArray payload = pending.mid(offset + kMessageHeader, int(size));
+        offset += kMessageHeader + int(size);
+
+        if (kind == kWhole) {
+            state = payload;
+            haveState = true;
+        } else if (kind == kDelta && haveState && sequence == lastSequence + 1) {
+            if (!SimSnapshot::applyDelta(state, payload, scratch)) {
+                haveState = false;
+                continue;
+            }
+            state.swap(scratch);
+        } else {
+            continue;   // waiting for a whole snapshot
+        }
+        lastSequence = sequence;
+        changed = true;
+    }
+    pending.remove(0, offset);
+
+    return changed && SimSnapshot::load(sim, state);
+}
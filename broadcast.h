@@ -0,0 +1,84 @@
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include <QByteArray>
+#include <QString>
+#include <vector>
+
+#include "gamesim.h"
+
+class QObject;
+class QTcpServer;
+class QTcpSocket;
+
+// ======================================================
+// Spectator stream: the running game published to viewers
+// over local TCP.
+//
+// Each publish turns the simulation into one message, a
+// SimSnapshot delta against the previous publish or a whole
+// snapshot every kKeyframeEvery, and hands that same shared
+// QByteArray to every socket, so encoding happens once however
+// many are watching and no viewer's bytes are copied on our
+// side. A viewer that joins, or falls kMaxBacklog behind and is
+// skipped, gets the next whole snapshot instead.
+//
+// Message: u32 payload bytes, u8 kind (0 whole, 1 delta),
+// u32 sequence, payload
+// ======================================================
+class BroadcastServer
+{
+public:
+    static constexpr int kKeyframeEvery = 60;          // publishes
+    static constexpr qint64 kMaxBacklog = 256 * 1024;  // unsent bytes per viewer
+
+    BroadcastServer(quint16 port, QObject *owner);
+    ~BroadcastServer();
+
+    bool isListening() const;
+    quint16 port() const;
+    int viewers() const { return int(viewerList.size()); }
+
+    // Once per frame, after its fixed steps
+    void publish(const GameSimulation &sim);
+
+private:
+    struct Viewer {
+        QTcpSocket *socket;
+        bool needsWhole;
+    };
+    void accept();
+
+    QTcpServer *server = nullptr;
+    std::vector<Viewer> viewerList;
+    QByteArray current;     // this publish's snapshot
+    QByteArray previous;
+    QByteArray delta;
+    quint32 sequence = 0;
+};
+
+// ======================================================
+// Receiving end: follows a BroadcastServer and keeps a copy
+// of the publisher's simulation up to date
+// ======================================================
+class BroadcastViewer
+{
+public:
+    BroadcastViewer(const QString &host, quint16 port, QObject *owner);
+    ~BroadcastViewer();
+
+    bool isConnected() const;
+    // Applies every complete message that has arrived; true when
+    // sim changed
+    bool update(GameSimulation &sim);
+
+private:
+    QTcpSocket *socket = nullptr;
+    QByteArray pending;     // bytes of a message still arriving
+    QByteArray state;       // publisher's latest snapshot
+    QByteArray scratch;
+    quint32 lastSequence = 0;
+    bool haveState = false;
+};
+
+#endif // BROADCAST_H
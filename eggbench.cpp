@@ -0,0 +1,1698 @@
+// ======================================================
+// eggbench: benchmarks for the game's hot paths
+//
+//   eggbench parse <stream|dom> <megabytes>
+//   eggbench backend <memory|local> <entries>
+//   eggbench http <submissions>
+//   eggbench raster <iterations>
+//   eggbench frames <check|record> <baseline.json> [threshold %]
+//   eggbench golden <check|record> <directory> [max differing %]
+//   eggbench particles <bursts per step>
+//   eggbench snapshot
+//   eggbench netplay <players> [loss %] [latency ms]
+//   eggbench broadcast <viewers>
+//   eggbench bots <simulations> <seconds>
+//   eggbench trajectory <eggs>
+//   eggbench fastforward <seconds>
+//   eggbench recount <leaderboard url>
+//
+// Each mode is meant to run in its own process so the peak
+// resident size reported at the end belongs to that mode only.
+// ======================================================
+#include "assetcache.h"
+#include "basketbot.h"
+#include "broadcast.h"
+#include "eggraster.h"
+#include "fastforward.h"
+#include "gamerenderer.h"
+#include "gamesim.h"
+#include "leaderboardmanager.h"
+#include "leaderboardparser.h"
+#include "particlepool.h"
+#include "netsession.h"
+#include "simsnapshot.h"
+#include "trajectory.h"
+
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QtMath>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+static QTextStream out(stdout);
+
+/* -------------------------------------------------------------
+   ALLOCATION COUNTER
+   On glibc the malloc family is wrapped, which also sees Qt's
+   containers and QString; elsewhere only operator new counts.
+--------------------------------------------------------------*/
+static std::atomic<qint64> allocations{0};
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+#else
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+#endif
+
+static qint64 peakRssKb()
+{
+#ifdef Q_OS_UNIX
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;   // KB on Linux
+#else
+    return -1;
+#endif
+}
+
+/* -------------------------------------------------------------
+   LEADERBOARD PARSING
+--------------------------------------------------------------*/
+static QString syntheticPayload(int megabytes)
+{
+    QString path = QDir::tempPath() + QString("/eggbench-leaderboard-%1mb.json").arg(megabytes);
+    if (QFile::exists(path))
+        return path;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return QString();
+
+    QRandomGenerator rng(1234);
+    const qint64 target = qint64(megabytes) * 1024 * 1024;
+    qint64 written = 0;
+    int id = 0;
+
+    file.write("{");
+    while (written < target) {
+        QByteArray rec = QString("%1\"dev-%2-%3\":{\"name\":\"Player%4\",\"score\":%5}")
+                             .arg(id ? "," : "")
+                             .arg(id, 8, 10, QChar('0'))
+                             .arg(rng.generate(), 8, 16, QChar('0'))
+                             .arg(rng.bounded(10000))
+                             .arg(rng.bounded(100000))
+                             .toUtf8();
+        file.write(rec);
+        written += rec.size();
+        ++id;
+    }
+    file.write("}");
+    return path;
+}
+
+static int benchParse(const QString &mode, int megabytes)
+{
+    QString path = syntheticPayload(megabytes);
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        out << "cannot create payload\n";
+        return 1;
+    }
+
+    qint64 baseRss = peakRssKb();
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<ScoreEntry> top;
+    qint64 records = 0;
+
+    if (mode == "stream") {
+        // Same pattern as LeaderboardManager::fetchScores
+        LeaderboardStreamParser parser(LeaderboardManager::kTopEntries);
+        char buf[RestLeaderboardBackend::kReadChunk];
+        qint64 n;
+        while ((n = file.read(buf, sizeof(buf))) > 0)
+            parser.feed(buf, n);
+        records = parser.recordCount();
+        top = parser.takeTop();
+    } else {
+        // The old path: readAll + DOM + copy every record + sort
+        QByteArray raw = file.readAll();
+        QJsonObject root = QJsonDocument::fromJson(raw).object();
+        for (auto it = root.begin(); it != root.end(); ++it) {
+            QJsonObject obj = it.value().toObject();
+            top.push_back({ obj["name"].toString(), obj["score"].toInt() });
+        }
+        records = top.size();
+        std::sort(top.begin(), top.end(),
+                  [](auto &a, auto &b) { return a.score > b.score; });
+        top.resize(qMin<int>(top.size(), LeaderboardManager::kTopEntries));
+    }
+
+    qint64 ms = timer.elapsed();
+    out << mode << " " << megabytes << " MB: " << records << " records, "
+        << ms << " ms, peak RSS +" << (peakRssKb() - baseRss) / 1024 << " MB"
+        << ", best " << (top.isEmpty() ? 0 : top.first().score) << "\n";
+    return 0;
+}
+
+/* -------------------------------------------------------------
+   LEADERBOARD BACKENDS: N inserts, N rank lookups, N around-me
+   windows, top 100
+--------------------------------------------------------------*/
+static int benchBackend(const QString &kind, int entries)
+{
+    QString path = QDir::tempPath() + "/eggbench-leaderboard.bin";
+    QFile::remove(path);
+
+    std::unique_ptr<LeaderboardBackend> backend =
+        LeaderboardManager::createBackend(kind == "local" ? "local:" + path : kind);
+
+    QStringList ids;
+    ids.reserve(entries);
+    for (int i = 0; i < entries; ++i)
+        ids << QString("dev-%1").arg(i, 8, 10, QChar('0'));
+
+    QRandomGenerator rng(99);
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; i < entries; ++i)
+        backend->submit(ids[i], "Player", rng.bounded(100000));
+    qint64 insertMs = timer.restart();
+
+    qint64 rankSum = 0;
+    for (int i = 0; i < entries; ++i)
+        rankSum += backend->rankOf(ids[rng.bounded(entries)]);
+    qint64 rankMs = timer.restart();
+
+    qint64 aroundRows = 0;
+    for (int i = 0; i < entries; ++i)
+        aroundRows += backend->around(ids[rng.bounded(entries)], 2).size();
+    qint64 aroundMs = timer.restart();
+
+    QVector<ScoreEntry> top = backend->top(100);
+    qint64 topUs = timer.nsecsElapsed() / 1000;
+
+    out << kind << " " << entries << " entries: insert " << insertMs << " ms ("
+        << insertMs * 1e6 / entries << " ns/op), rank " << rankMs << " ms ("
+        << rankMs * 1e6 / entries << " ns/op), around " << aroundMs << " ms ("
+        << aroundMs * 1e6 / entries << " ns/op, " << aroundRows / qMax(1, entries)
+        << " rows), top100 " << topUs << " us"
+        << ", avg rank " << rankSum / qMax(1, entries)
+        << ", best " << (top.isEmpty() ? 0 : top.first().score) << "\n";
+
+    backend.reset();
+    QFile::remove(path);
+    return 0;
+}
+
+/* -------------------------------------------------------------
+   LEADERBOARD HTTP: a small Firebase-like server in this process
+   that counts connections and requests while the REST backend
+   submits scores and a burst of identical reads.
+--------------------------------------------------------------*/
+struct FakeFirebase
+{
+    QTcpServer server;
+    QHash<QString, QByteArray> records;     // id -> JSON body
+    QHash<QString, int> versions;           // id -> ETag
+    QJsonObject counts;                     // leaderboard_counts: records per score
+    int countsVersion = 0;                  // its ETag, 0 while empty
+    QHash<QTcpSocket *, QByteArray> inbox;
+
+    int connections = 0;
+    int gets = 0;
+    int puts = 0;
+    int conflicts = 0;
+    int deflated = 0;
+    int countUpdates = 0;
+
+    QByteArray etagOf(const QString &id) const
+    {
+        return versions.contains(id) ? QByteArray::number(versions[id]) : "null_etag";
+    }
+
+    void reply(QTcpSocket *sock, int status, QByteArray body, const QByteArray &etag, bool deflate)
+    {
+        QByteArray head = QString("HTTP/1.1 %1 %2\r\n")
+                              .arg(status)
+                              .arg(status == 412 ? "Precondition Failed" : "OK")
+                              .toLatin1();
+        head += "Content-Type: application/json\r\n";
+        if (!etag.isEmpty())
+            head += "ETag: " + etag + "\r\n";
+        if (deflate) {
+            body = qCompress(body).mid(4);  // strip Qt's length prefix, leaves a zlib stream
+            head += "Content-Encoding: deflate\r\n";
+            ++deflated;
+        }
+        head += "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n";
+        sock->write(head + body);
+    }
+
+    void handle(QTcpSocket *sock, const QByteArray &method, const QByteArray &target,
+                const QHash<QByteArray, QByteArray> &headers, const QByteArray &body)
+    {
+        int query = target.indexOf('?');
+        QString path = QString::fromLatin1(query < 0 ? target : target.left(query));
+        bool deflate = headers.value("accept-encoding").contains("deflate");
+
+        if (path == "/leaderboard.json") {
+            ++gets;
+            QByteArray all = "{";
+            for (auto it = records.cbegin(); it != records.cend(); ++it) {
+                if (all.size() > 1) all += ',';
+                all += '"' + it.key().toLatin1() + "\":" + it.value();
+            }
+            all += '}';
+            reply(sock, 200, all, QByteArray(), deflate);
+            return;
+        }
+
+        if (path == "/leaderboard_counts.json") {
+            auto etagNow = [this]() { return countsVersion ? QByteArray::number(countsVersion) : "null_etag"; };
+            const QByteArray etag = etagNow();
+            if (method == "PATCH") {
+                ++countUpdates;
+                const QJsonObject change = QJsonDocument::fromJson(body).object();
+                for (auto it = change.constBegin(); it != change.constEnd(); ++it)
+                    counts[it.key()] = counts[it.key()].toInt()
+                                       + it.value().toObject()[".sv"].toObject()["increment"].toInt();
+                ++countsVersion;
+            } else if (method == "PUT") {
+                ++puts;
+                if (headers.contains("if-match") && headers.value("if-match") != etag) {
+                    ++conflicts;
+                    reply(sock, 412, QJsonDocument(counts).toJson(QJsonDocument::Compact), etag, deflate);
+                    return;
+                }
+                counts = QJsonDocument::fromJson(body).object();
+                ++countsVersion;
+            } else {
+                ++gets;
+            }
+            reply(sock, 200, QJsonDocument(counts).toJson(QJsonDocument::Compact), etagNow(), deflate);
+            return;
+        }
+
+        QString id = path.mid(13).chopped(5);    // /leaderboard/<id>.json
+        if (method == "GET") {
+            ++gets;
+            reply(sock, 200, records.value(id, "null"), etagOf(id), deflate);
+            return;
+        }
+
+        ++puts;
+        if (headers.contains("if-match") && headers.value("if-match") != etagOf(id)) {
+            ++conflicts;
+            reply(sock, 412, records.value(id, "null"), etagOf(id), deflate);
+            return;
+        }
+        records[id] = body;
+        versions[id] = versions.value(id) + 1;
+        reply(sock, 200, body, etagOf(id), deflate);
+    }
+
+    void serve(QTcpSocket *sock)
+    {
+        QByteArray &buf = inbox[sock];
+        buf += sock->readAll();
+
+        for (;;) {
+            int end = buf.indexOf("\r\n\r\n");
+            if (end < 0) return;
+
+            QList<QByteArray> lines = buf.left(end).split('\n');
+            QList<QByteArray> request = lines.first().trimmed().split(' ');
+            QHash<QByteArray, QByteArray> headers;
+            for (int i = 1; i < lines.size(); ++i) {
+                int colon = lines[i].indexOf(':');
+                if (colon > 0)
+                    headers.insert(lines[i].left(colon).trimmed().toLower(), lines[i].mid(colon + 1).trimmed());
+            }
+
+            int length = headers.value("content-length", "0").toInt();
+            if (buf.size() < end + 4 + length) return;
+
+            QByteArray body = buf.mid(end + 4, length);
+            buf.remove(0, end + 4 + length);
+            if (request.size() >= 2)
+                handle(sock, request[0], request[1], headers, body);
+        }
+    }
+
+    bool start()
+    {
+        QObject::connect(&server, &QTcpServer::newConnection, &server, [this]() {
+            while (QTcpSocket *sock = server.nextPendingConnection()) {
+                ++connections;
+                QObject::connect(sock, &QTcpSocket::readyRead, sock, [this, sock]() { serve(sock); });
+                QObject::connect(sock, &QTcpSocket::disconnected, sock, [this, sock]() {
+                    inbox.remove(sock);
+                    sock->deleteLater();
+                });
+            }
+        });
+        return server.listen(QHostAddress::LocalHost, 0);
+    }
+};
+
+static int benchHttp(int submissions)
+{
+    FakeFirebase fake;
+    if (!fake.start()) {
+        out << "cannot listen\n";
+        return 1;
+    }
+
+    RestLeaderboardBackend backend(QString("http://127.0.0.1:%1/leaderboard").arg(fake.server.serverPort()));
+    backend.warmUp();
+
+    // A table from before the histogram: no rank until it is recounted
+    const int legacy = 3;
+    for (int i = 0; i < legacy; ++i) {
+        fake.records.insert(QString("old-%1").arg(i), QString("{\"name\":\"Old\",\"score\":%1}").arg(1000000 + i).toLatin1());
+        fake.versions.insert(QString("old-%1").arg(i), 1);
+    }
+    const int unseededRank = backend.rankOf("old-0");
+    const bool recounted = backend.rebuildCounts();
+    const int requestsBefore = fake.gets + fake.puts;
+    const int conflictsBefore = fake.conflicts;
+
+    // A few players improving their score, so every submit is a real write
+    const int players = qMax(1, qMin(submissions, 8));
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < submissions; ++i)
+        backend.submit(QString("dev-%1").arg(i % players), "Player", i);
+    qint64 submitMs = timer.restart();
+    int submitRequests = fake.gets + fake.puts - requestsBefore;
+
+    // Identical reads issued while the first one is still on the wire
+    int getsBefore = fake.gets;
+    const int burst = 4;
+    for (int i = 0; i < burst; ++i)
+        QTimer::singleShot(0, [&backend]() { backend.top(LeaderboardManager::kTopEntries); });
+    QVector<ScoreEntry> top = backend.top(LeaderboardManager::kTopEntries);
+    QCoreApplication::processEvents();
+    int burstGets = fake.gets - getsBefore;
+    int rank = backend.rankOf("dev-0");
+    int oldRank = backend.rankOf("old-0");
+
+    out << "http " << submissions << " submissions: " << submitMs << " ms, "
+        << submitRequests << " requests (" << double(submitRequests) / qMax(1, submissions)
+        << " per submit, " << fake.conflicts - conflictsBefore << " conflicts, " << fake.countUpdates << " count updates), "
+        << burst + 1 << " concurrent reads -> " << burstGets << " GET, "
+        << fake.connections << " connection(s), " << fake.deflated << " deflated responses"
+        << ", best " << (top.isEmpty() ? 0 : top.first().score)
+        << ", rank of dev-0 " << rank << " of " << players + legacy
+        << ", of old-0 " << unseededRank << " before recount, " << oldRank << " after\n";
+
+    // Unknown until recounted, then old-0 is behind the other two old scores
+    return unseededRank == 0 && recounted && oldRank == legacy ? 0 : 1;
+}
+
+/* -------------------------------------------------------------
+   RECOUNT: not a benchmark. Rebuilds a REST leaderboard's score
+   histogram from a full read (RestLeaderboardBackend::
+   rebuildCounts); run once on a table that predates it, or
+   when ranks look wrong. Best run while few games are played.
+--------------------------------------------------------------*/
+static int recountLeaderboard(const QString &url)
+{
+    RestLeaderboardBackend backend(url);
+    const bool ok = backend.rebuildCounts();
+    out << (ok ? "recounted " : "recount failed for ") << url << "\n";
+    return ok ? 0 : 1;
+}
+
+/* -------------------------------------------------------------
+   EGG RASTER: the old per-call midpoint plotter (kept here as
+   the reference) against the memoized spans, box sizes 2..64.
+   Both draw into the same target; the images must match.
+--------------------------------------------------------------*/
+static void legacyDrawEggShape(QPainter &p, int cx, int cy, int box)
+{
+    p.setBrush(Qt::white);
+    p.setPen(Qt::NoPen);
+
+    auto plot = [&](int gx, int gy){
+        p.fillRect(gx * box, gy * box, box, box, Qt::white);
+    };
+
+    /* ======================================================
+       SEMICIRCLE BOTTOM
+       (midpoint circle)
+    ====================================================== */
+    int r = box;
+    int x = 0;
+    int y = r;
+    int d = 1 - r;
+
+    QVector<QPoint> boundary;
+
+    while (x <= y)
+    {
+        int px[4] = { x,  y, -x, -y };
+        int py[4] = { y,  x,  y,  x };
+
+        for (int i = 0; i < 4; i++)
+        {
+            int gx = cx + px[i];
+            int gy = cy + py[i];
+            if (gy >= cy)
+                boundary.push_back({gx, gy});
+        }
+
+        x++;
+        if (d < 0) d += 2*x + 1;
+        else { y--; d += 2*(x - y) + 1; }
+    }
+
+    /* ======================================================
+       TOP ELLIPSE
+       (midpoint ellipse)
+    ====================================================== */
+    int rx = box;
+    int ry = box * 1.5;
+    int rx2 = rx * rx;
+    int ry2 = ry * ry;
+    int ex = 0;
+    int ey = ry;
+
+    float d1 = ry2 - rx2 * ry + (0.25f * rx2);
+    int dx = 2 * ry2 * ex;
+    int dy = 2 * rx2 * ey;
+
+    while (dx < dy)
+    {
+        boundary.push_back({cx + ex, cy - ey});
+        boundary.push_back({cx - ex, cy - ey});
+
+        if (d1 < 0) {
+            ex++;
+            dx += 2*ry2;
+            d1 += dx + ry2;
+        } else {
+            ex++; ey--;
+            dx += 2*ry2;
+            dy -= 2*rx2;
+            d1 += dx - dy + ry2;
+        }
+    }
+
+    float d2 =
+        (ry2)*(ex+0.5f)*(ex+0.5f) +
+        (rx2)*(ey-1)*(ey-1) -
+        (rx2*ry2);
+
+    while (ey >= 0)
+    {
+        boundary.push_back({cx + ex, cy - ey});
+        boundary.push_back({cx - ex, cy - ey});
+
+        if (d2 > 0) {
+            ey--;
+            dy -= 2*rx2;
+            d2 += rx2 - dy;
+        } else {
+            ey--; ex++;
+            dx += 2*ry2;
+            dy -= 2*rx2;
+            d2 += dx - dy + rx2;
+        }
+    }
+
+    /* ======================================================
+       FILL SCANLINES INSIDE
+    ====================================================== */
+    std::sort(boundary.begin(), boundary.end(),
+              [](auto &a, auto &b){
+                  return (a.y() == b.y()) ? a.x() < b.x() : a.y() < b.y();
+              });
+
+    int i = 0;
+    while (i < boundary.size())
+    {
+        int y = boundary[i].y();
+        QVector<int> xs;
+
+        while (i < boundary.size() && boundary[i].y() == y) {
+            xs.push_back(boundary[i].x());
+            i++;
+        }
+
+        std::sort(xs.begin(), xs.end());
+        for (int k = 0; k + 1 < xs.size(); k += 2) {
+            for (int xF = xs[k]; xF <= xs[k+1]; xF++)
+                plot(xF, y);
+        }
+    }
+}
+
+static int benchRaster(int iterations)
+{
+    const int side = 1024;
+    QImage legacy(side, side, QImage::Format_ARGB32_Premultiplied);
+    QImage spans(side, side, QImage::Format_ARGB32_Premultiplied);
+
+    out << "box  legacy us  spans us  speedup  match\n";
+    for (int box = 2; box <= 64; ++box) {
+        // Centre cell in the middle of the target; large eggs get clipped
+        int c = side / 2 / box;
+
+        legacy.fill(Qt::black);
+        spans.fill(Qt::black);
+        {
+            QPainter lp(&legacy);
+            legacyDrawEggShape(lp, c, c, box);
+            QPainter sp(&spans);
+            EggRaster::draw(sp, c, c, box);
+        }
+        bool match = (legacy == spans);
+
+        QElapsedTimer timer;
+        QPainter lp(&legacy);
+        timer.start();
+        for (int i = 0; i < iterations; ++i)
+            legacyDrawEggShape(lp, c, c, box);
+        double legacyUs = timer.nsecsElapsed() / 1000.0 / iterations;
+        lp.end();
+
+        QPainter sp(&spans);
+        timer.restart();
+        for (int i = 0; i < iterations; ++i)
+            EggRaster::draw(sp, c, c, box);
+        double spansUs = timer.nsecsElapsed() / 1000.0 / iterations;
+        sp.end();
+
+        out << qSetFieldWidth(3) << box << qSetFieldWidth(0) << "  "
+            << qSetFieldWidth(9) << legacyUs << qSetFieldWidth(0) << "  "
+            << qSetFieldWidth(8) << spansUs << qSetFieldWidth(0) << "  "
+            << qSetFieldWidth(6) << legacyUs / qMax(spansUs, 1e-3) << qSetFieldWidth(0) << "x  "
+            << (match ? "yes" : "NO") << "\n";
+    }
+    return 0;
+}
+
+/* -------------------------------------------------------------
+   FRAME-TIME GATE
+   A fixed-seed game steps at 120 Hz and is drawn at 60 Hz into
+   an offscreen QImage. The script keeps the costly cases on
+   screen: a full field of eggs, wind, focus mode and splat
+   bursts. Only render() is timed; allocations are counted
+   around it too.
+--------------------------------------------------------------*/
+static constexpr int kGateFrames = 1800;
+static constexpr int kGateWarmup = 60;
+static constexpr int kGateSide = 600;
+static constexpr int kGateBox = 6;
+static constexpr quint32 kGateSeed = 20240601;
+
+static void scriptFrame(GameSimulation &sim, int frame)
+{
+    sim.lives = kMaxLives;   // the scenario never ends
+
+    // Extra rain on top of the normal spawner; most of it splats
+    if (frame % 3 == 0) {
+        Egg e;
+        e.pos = QPointF(sim.rng.bounded(sim.cols), 0.0f);
+        e.prevY = 0.0f;
+        e.yVelocity = 0.0f;
+        e.type = EggType(frame / 3 % int(EggType::Count));
+        sim.eggs.append(e);
+    }
+
+    // Wind for the middle of the run, switching side every 5 s
+    if (frame >= 300 && frame < 1500) {
+        sim.windActive = true;
+        sim.windStrength = (frame / 300) % 2 ? -4.0f : 4.0f;
+        sim.windTimer = 1.0f;
+    }
+
+    // Score into the first focus window for the second half
+    if (frame == kGateFrames / 2)
+        sim.score = qMax(sim.score, 50);
+
+    // Sweep the basket: 2 s right, 2 s left
+    if (frame % 120 == 0) {
+        bool right = (frame / 120) % 2 == 0;
+        sim.steer.apply({ 0, InputSource::Keyboard, right ? InputAction::Left : InputAction::Right, false });
+        sim.steer.apply({ 0, InputSource::Keyboard, right ? InputAction::Right : InputAction::Left, true });
+    }
+}
+
+static double percentile(QVector<double> sorted, double p)
+{
+    if (sorted.isEmpty())
+        return 0.0;
+    int i = qBound(0, int(p * (sorted.size() - 1) + 0.5), int(sorted.size()) - 1);
+    return sorted[i];
+}
+
+static QJsonObject runFrames()
+{
+    GameSimulation sim(qMax(40, kGateSide / kGateBox), qMax(30, kGateSide / kGateBox));
+    sim.reset(kGateSeed);
+
+    AssetCache assets(QCoreApplication::instance(), kGateSide, kGateBox);
+    GameRenderer renderer(kGateSide, kGateBox);
+    renderer.setCanvas(kGateSide, 1.0);
+    renderer.setAssets(assets.buildNow(kGateSide, 1.0));
+
+    QImage target(kGateSide, kGateSide, QImage::Format_ARGB32_Premultiplied);
+    QVector<double> frameUs;
+    QVector<qint64> frameAllocs;
+    frameUs.reserve(kGateFrames);
+    frameAllocs.reserve(kGateFrames);
+
+    QElapsedTimer timer;
+    for (int frame = 0; frame < kGateWarmup + kGateFrames; ++frame) {
+        scriptFrame(sim, frame);
+        sim.step(sim.fixedDelta);
+        sim.step(sim.fixedDelta);
+
+        qint64 allocsBefore = allocations.load(std::memory_order_relaxed);
+        timer.start();
+        QPainter painter(&target);
+        renderer.render(painter, sim, 0.5f);
+        painter.end();
+        qint64 ns = timer.nsecsElapsed();
+        qint64 allocs = allocations.load(std::memory_order_relaxed) - allocsBefore;
+
+        if (frame >= kGateWarmup) {
+            frameUs.append(ns / 1000.0);
+            frameAllocs.append(allocs);
+        }
+    }
+
+    QVector<double> sorted = frameUs;
+    std::sort(sorted.begin(), sorted.end());
+    qint64 allocTotal = 0;
+    qint64 allocMax = 0;
+    for (qint64 a : frameAllocs) {
+        allocTotal += a;
+        allocMax = qMax(allocMax, a);
+    }
+
+    QJsonObject result;
+    result["frames"] = kGateFrames;
+    result["side"] = kGateSide;
+    result["p50_us"] = percentile(sorted, 0.50);
+    result["p95_us"] = percentile(sorted, 0.95);
+    result["p99_us"] = percentile(sorted, 0.99);
+    result["allocs_per_frame"] = double(allocTotal) / qMax(1, int(frameAllocs.size()));
+    result["allocs_max"] = double(allocMax);
+    return result;
+}
+
+// Exit code: 0 within the threshold, 1 regressed, 2 no usable baseline
+static int benchFrames(const QString &mode, const QString &baselinePath, double thresholdPct)
+{
+    static const char *metrics[] = { "p50_us", "p95_us", "p99_us", "allocs_per_frame", "allocs_max" };
+    QJsonObject current = runFrames();
+
+    if (mode == "record") {
+        QFile file(baselinePath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            out << "cannot write " << baselinePath << "\n";
+            return 2;
+        }
+        file.write(QJsonDocument(current).toJson());
+        out << "recorded " << baselinePath << "\n";
+        for (const char *m : metrics)
+            out << "  " << m << " " << current[m].toDouble() << "\n";
+        return 0;
+    }
+
+    QFile file(baselinePath);
+    QJsonObject baseline;
+    if (file.open(QIODevice::ReadOnly))
+        baseline = QJsonDocument::fromJson(file.readAll()).object();
+    if (baseline.isEmpty()) {
+        out << "FAIL: no baseline at " << baselinePath << "\n"
+            << "  nothing was checked. Record one on the reference machine\n"
+            << "  (eggbench frames record <path>, or the perfgate-record target)\n"
+            << "  and commit it.\n";
+        return 2;
+    }
+
+    bool regressed = false;
+    out << "metric              baseline   current   change\n";
+    for (const char *m : metrics) {
+        double base = baseline[m].toDouble();
+        double now = current[m].toDouble();
+        // Counts get one allocation of slack so a zero baseline can still pass
+        double limit = base * (1.0 + thresholdPct / 100.0) + (QByteArray(m).startsWith("allocs") ? 1.0 : 0.0);
+        bool bad = now > limit;
+        regressed |= bad;
+
+        out << qSetFieldWidth(18) << Qt::left << m << qSetFieldWidth(0) << Qt::right << "  "
+            << qSetFieldWidth(8) << base << qSetFieldWidth(0) << "  "
+            << qSetFieldWidth(8) << now << qSetFieldWidth(0) << "  "
+            << qSetFieldWidth(6) << (base > 0 ? (now / base - 1.0) * 100.0 : 0.0) << qSetFieldWidth(0) << "%"
+            << (bad ? "  REGRESSED" : "") << "\n";
+    }
+    out << (regressed ? "FAIL" : "PASS") << " (threshold " << thresholdPct << "%)\n";
+    return regressed ? 1 : 0;
+}
+
+/* -------------------------------------------------------------
+   GOLDEN IMAGES
+   Hand-built simulation states, drawn offscreen and compared
+   with PNGs recorded earlier. Pixels are compared by YIQ
+   distance (the pixelmatch metric), so anti-aliasing noise
+   passes while a wrong colour, shape or missing element fails.
+   Failures leave <name>.actual.png and <name>.diff.png in
+   the temp directory.
+--------------------------------------------------------------*/
+struct GoldenCase {
+    const char *name;
+    qreal dpr;
+    void (*setup)(GameSimulation &sim);
+};
+
+static Egg goldenEgg(float x, float y, EggType type, EggState state = EggState::Falling, float anim = 0.0f)
+{
+    Egg e;
+    e.pos = QPointF(x, y);
+    e.prevY = y;
+    e.yVelocity = 0.0f;
+    e.type = type;
+    e.state = state;
+    e.animTimer = anim;
+    if (state == EggState::Caught) {
+        e.scale = 1.0f - anim * 3.0f;
+        e.alpha = 1.0f - anim * 2.0f;
+    }
+    return e;
+}
+
+static void stepFor(GameSimulation &sim, int steps)
+{
+    for (int i = 0; i < steps; ++i) {
+        sim.lives = kMaxLives;
+        sim.step(sim.fixedDelta);
+    }
+}
+
+static const GoldenCase kGoldenCases[] = {
+    { "egg_types", 1.0, [](GameSimulation &sim) {
+          for (int t = 0; t < int(EggType::Count); ++t)
+              sim.eggs.append(goldenEgg(20.0f + t * 25.0f, 30.0f, EggType(t)));
+      } },
+    { "caught_phases", 1.0, [](GameSimulation &sim) {
+          const float phases[] = { 0.0f, 0.05f, 0.15f, 0.3f };
+          for (int i = 0; i < 4; ++i)
+              sim.eggs.append(goldenEgg(15.0f + i * 22.0f, 80.0f, EggType::Normal, EggState::Caught, phases[i]));
+      } },
+    { "splat_burst", 1.0, [](GameSimulation &sim) {
+          for (int t = 0; t < int(EggType::Count); ++t) {
+              Egg e = goldenEgg(10.0f + t * 12.0f, sim.rows - 1.2f, EggType(t));
+              e.yVelocity = 20.0f;
+              sim.eggs.append(e);
+          }
+          stepFor(sim, 12);   // land, burst, let the particles spread
+      } },
+    { "wind_right", 1.0, [](GameSimulation &sim) {
+          sim.windActive = true;
+          sim.windStrength = 5.0f;
+          sim.windTimer = 2.0f;
+          stepFor(sim, 40);
+      } },
+    { "wind_left", 1.0, [](GameSimulation &sim) {
+          sim.windActive = true;
+          sim.windStrength = -5.0f;
+          sim.windTimer = 2.0f;
+          stepFor(sim, 40);
+      } },
+    { "focus_mode", 1.0, [](GameSimulation &sim) {
+          sim.score = 60;
+          sim.highScore = 120;
+          stepFor(sim, 1);
+          sim.eggs.append(goldenEgg(30.0f, 40.0f, EggType::Normal));
+          sim.eggs.append(goldenEgg(70.0f, 55.0f, EggType::Bad));
+      } },
+    { "hearts_pulse", 1.0, [](GameSimulation &sim) {
+          sim.lives = kMaxLives;
+          sim.livesPulseTimer = 0.15f;
+          sim.scoreScale = 1.4f;
+          sim.score = 7;
+      } },
+    { "hearts_low", 1.0, [](GameSimulation &sim) {
+          sim.lives = 1;
+      } },
+    { "flash", 1.0, [](GameSimulation &sim) {
+          sim.flashColor = QColor::fromRgba(eggTraits(EggType::Life).flash);
+          sim.flashAlpha = 0.8f;
+      } },
+    { "hidpi_mixed", 2.0, [](GameSimulation &sim) {
+          sim.windActive = true;
+          sim.windStrength = 3.0f;
+          sim.windTimer = 2.0f;
+          sim.eggs.append(goldenEgg(40.0f, 40.0f, EggType::Life));
+          sim.eggs.append(goldenEgg(60.0f, 60.0f, EggType::Normal, EggState::Caught, 0.1f));
+          stepFor(sim, 20);
+      } },
+};
+
+static QImage renderGolden(const GoldenCase &c)
+{
+    GameSimulation sim(qMax(40, kGateSide / kGateBox), qMax(30, kGateSide / kGateBox));
+    sim.reset(kGateSeed);
+    c.setup(sim);
+
+    AssetCache assets(QCoreApplication::instance(), kGateSide, kGateBox);
+    GameRenderer renderer(kGateSide, kGateBox);
+    renderer.setCanvas(kGateSide, c.dpr);
+    renderer.setAssets(assets.buildNow(kGateSide, c.dpr));
+
+    const int physical = qCeil(kGateSide * c.dpr);
+    QImage image(physical, physical, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(c.dpr);
+    QPainter painter(&image);
+    renderer.render(painter, sim, 1.0f);
+    painter.end();
+    return image;
+}
+
+// Squared YIQ distance, 0..35215 for opaque pixels
+static double yiqDistance(QRgb a, QRgb b)
+{
+    auto yiq = [](QRgb p, double &y, double &i, double &q) {
+        double r = qRed(p), g = qGreen(p), bl = qBlue(p);
+        y = r * 0.29889531 + g * 0.58662247 + bl * 0.11448223;
+        i = r * 0.59597799 - g * 0.27417610 - bl * 0.32180189;
+        q = r * 0.21147017 - g * 0.52261711 + bl * 0.31114694;
+    };
+    double y1, i1, q1, y2, i2, q2;
+    yiq(a, y1, i1, q1);
+    yiq(b, y2, i2, q2);
+    return 0.5053 * (y1 - y2) * (y1 - y2) + 0.299 * (i1 - i2) * (i1 - i2)
+           + 0.1957 * (q1 - q2) * (q1 - q2);
+}
+
+// Differing pixels; fills `diff` with them in red over a faded copy of `golden`
+static qint64 compareImages(const QImage &golden, const QImage &actual, QImage &diff)
+{
+    const double maxDelta = 35215.0 * 0.1 * 0.1;   // pixelmatch's default threshold
+    diff = QImage(golden.size(), QImage::Format_ARGB32);
+    qint64 differing = 0;
+
+    for (int y = 0; y < golden.height(); ++y) {
+        const QRgb *g = reinterpret_cast<const QRgb *>(golden.constScanLine(y));
+        const QRgb *a = reinterpret_cast<const QRgb *>(actual.constScanLine(y));
+        QRgb *d = reinterpret_cast<QRgb *>(diff.scanLine(y));
+        for (int x = 0; x < golden.width(); ++x) {
+            if (g[x] != a[x] && yiqDistance(g[x], a[x]) > maxDelta) {
+                d[x] = qRgb(255, 0, 0);
+                ++differing;
+            } else {
+                int grey = 255 - (255 - qGray(g[x])) / 4;
+                d[x] = qRgb(grey, grey, grey);
+            }
+        }
+    }
+    return differing;
+}
+
+// Exit code: 0 all match, 1 some differ, 2 missing/unwritable goldens
+static int benchGolden(const QString &mode, const QString &directory, double maxDifferingPct)
+{
+    QDir dir(directory);
+    if (mode == "record" && !dir.mkpath("."))
+        return 2;
+
+    const QString failDir = QDir::tempPath() + "/eggbench-golden";
+    int failed = 0;
+    int missing = 0;
+
+    for (const GoldenCase &c : kGoldenCases) {
+        QImage actual = renderGolden(c);
+        const QString path = dir.filePath(QString(c.name) + ".png");
+
+        if (mode == "record") {
+            bool ok = actual.save(path);
+            out << (ok ? "recorded " : "cannot write ") << path << "\n";
+            missing += ok ? 0 : 1;
+            continue;
+        }
+
+        QImage golden(path);
+        if (golden.isNull()) {
+            out << qSetFieldWidth(14) << Qt::left << c.name << qSetFieldWidth(0) << Qt::right
+                << "  MISSING " << path << "\n";
+            ++missing;
+            continue;
+        }
+        golden = golden.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        actual = actual.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+        double pct = 100.0;
+        QImage diff;
+        if (golden.size() == actual.size())
+            pct = 100.0 * compareImages(golden, actual, diff) / (qint64(golden.width()) * golden.height());
+        bool bad = pct > maxDifferingPct;
+
+        out << qSetFieldWidth(14) << Qt::left << c.name << qSetFieldWidth(0) << Qt::right << "  "
+            << qSetFieldWidth(8) << pct << qSetFieldWidth(0) << "% differ"
+            << (bad ? "  FAIL" : "") << "\n";
+        if (bad) {
+            ++failed;
+            QDir().mkpath(failDir);
+            actual.save(failDir + "/" + c.name + ".actual.png");
+            if (!diff.isNull())
+                diff.save(failDir + "/" + c.name + ".diff.png");
+        }
+    }
+
+    if (mode == "record")
+        return missing ? 2 : 0;
+    if (failed)
+        out << failed << " case(s) differ, see " << failDir << "\n";
+    if (missing)
+        out << missing << " case(s) have no golden and were not checked. Record them on\n"
+            << "  the CI image (eggbench golden record <dir>, or the golden-record target)\n"
+            << "  and commit them.\n";
+    out << (failed || missing ? "FAIL" : "PASS") << " (max " << maxDifferingPct << "% differing)\n";
+    return missing ? 2 : failed ? 1 : 0;
+}
+
+/* -------------------------------------------------------------
+   PARTICLE POOL: N splat bursts every step for 10 s of steps,
+   the pool must stay inside its budget with no allocations
+--------------------------------------------------------------*/
+static int benchParticles(int burstsPerStep)
+{
+    const int steps = 1200;
+    ParticleRing<Particle> pool(GameSimulation::kSplatBudget);
+    QRandomGenerator rng(7);
+    int peakUsed = 0;
+
+    qint64 allocsBefore = allocations.load(std::memory_order_relaxed);
+    QElapsedTimer timer;
+    timer.start();
+    for (int s = 0; s < steps; ++s) {
+        for (int b = 0; b < burstsPerStep; ++b) {
+            Particle *burst = pool.spawnBurst(12);
+            for (int i = 0; i < 12; ++i) {
+                burst[i].origin = QPoint(rng.bounded(100000), rng.bounded(100000));
+                burst[i].velocity = QPoint(rng.bounded(-1500, 1500), rng.bounded(-1500, 1500));
+                burst[i].born = quint32(s);
+                burst[i].life = qint16(rng.bounded(30, 60));
+                burst[i].palette = quint8(i % int(EggType::Count));
+            }
+        }
+        pool.retire([s](const Particle &p) { return p.aliveAt(quint32(s)); });
+        peakUsed = qMax(peakUsed, pool.used());
+    }
+    int live = 0;
+    pool.forEach([&live](const Particle &p) { live += p.aliveAt(steps - 1); });
+    double us = timer.nsecsElapsed() / 1000.0 / steps;
+    qint64 allocs = allocations.load(std::memory_order_relaxed) - allocsBefore;
+
+    out << "bursts/step " << burstsPerStep << "  budget " << pool.budget()
+        << "  peak used " << peakUsed << "  live at end " << live << "\n"
+        << "step+spawn " << us << " us  allocations " << allocs
+        << "  pool bytes " << pool.budget() * qint64(sizeof(Particle)) << "\n";
+    return peakUsed <= pool.budget() && allocs == 0 ? 0 : 1;
+}
+
+/* -------------------------------------------------------------
+   SNAPSHOTS: the frames scenario (rain, 10 s of wind, focus)
+   with a rewind snapshot after every step. Must hold the last
+   10 s in under 5 MB at under 50 us a step, and rewinding the
+   whole buffer must give back the exact state from then.
+--------------------------------------------------------------*/
+static int benchSnapshot()
+{
+    const int rewindSteps = 1200;
+    const qint64 budgetBytes = 5 * 1024 * 1024;
+    const double budgetUs = 50.0;
+
+    GameSimulation sim(qMax(40, kGateSide / kGateBox), qMax(30, kGateSide / kGateBox));
+    sim.reset(kGateSeed);
+    RewindBuffer rewind(rewindSteps, std::numeric_limits<qint64>::max());
+
+    QVector<double> pushUs;
+    QByteArray expected;
+    qint64 peakBytes = 0;
+    int steps = 0;
+    QElapsedTimer timer;
+    for (int frame = 0; frame < kGateFrames; ++frame) {
+        scriptFrame(sim, frame);
+        for (int i = 0; i < 2; ++i) {
+            sim.step(sim.fixedDelta);
+            timer.start();
+            rewind.push(sim);
+            pushUs.append(timer.nsecsElapsed() / 1000.0);
+            peakBytes = qMax(peakBytes, rewind.bytes());
+            if (++steps == kGateFrames * 2 - rewindSteps)
+                expected = SimSnapshot::save(sim);
+        }
+    }
+
+    const int available = rewind.steps();
+    const qint64 bytes = rewind.bytes();
+    const QByteArray full = SimSnapshot::save(sim);
+
+    timer.start();
+    bool rewound = rewind.rewind(rewindSteps, sim);
+    double rewindMs = timer.nsecsElapsed() / 1e6;
+    bool exact = rewound && SimSnapshot::save(sim) == expected;
+
+    // A save state survives a trip through load into another simulation
+    GameSimulation copy(sim.cols, sim.rows);
+    bool roundTrip = SimSnapshot::load(copy, expected) && SimSnapshot::save(copy) == expected;
+
+    double mean = 0.0;
+    for (double us : pushUs)
+        mean += us;
+    mean /= qMax(1, int(pushUs.size()));
+    std::sort(pushUs.begin(), pushUs.end());
+
+    out << "snapshot " << full.size() << " bytes  steps kept " << available
+        << "  buffer " << bytes / 1024 << " KiB (peak " << peakBytes / 1024 << " KiB)\n"
+        << "push mean " << mean << " us  p99 " << percentile(pushUs, 0.99) << " us"
+        << "  rewind " << rewindSteps << " steps " << rewindMs << " ms\n"
+        << "rewound state " << (exact ? "exact" : "DIFFERS")
+        << "  save/load " << (roundTrip ? "exact" : "DIFFERS") << "\n";
+
+    bool pass = available == rewindSteps && peakBytes <= budgetBytes && mean <= budgetUs && exact && roundTrip;
+    out << (pass ? "PASS" : "FAIL") << " (" << budgetBytes / (1024 * 1024) << " MB, "
+        << budgetUs << " us/step)\n";
+    return pass ? 0 : 1;
+}
+
+/* -------------------------------------------------------------
+   NETPLAY: N versus peers in this process on loopback UDP,
+   paced at 120 steps/s, with scripted players and outgoing
+   packets dropped and delayed. Every peer must agree on the
+   state hash (though each starts with a different high score),
+   and with the default 100 ms of one-way latency
+   rollback should keep stalls under 1% of steps.
+--------------------------------------------------------------*/
+static int benchNetplay(int players, int lossPercent, int latencyMs)
+{
+    const int steps = 1200;
+    const qint64 stepNs = 1000000000LL / 120;
+    players = qBound(2, players, NetSession::kMaxPlayers);
+
+    NetSession::Config config;
+    config.seed = kGateSeed;
+    config.lossPercent = lossPercent;
+    config.latencyMs = latencyMs;
+    for (int p = 0; p < players; ++p)
+        config.peers.append({ QHostAddress(QHostAddress::LocalHost), quint16(NetSession::kBasePort + 100 + p) });
+
+    const int cols = qMax(40, kGateSide / kGateBox);
+    const int rows = qMax(30, kGateSide / kGateBox);
+    std::vector<std::unique_ptr<GameSimulation>> sims;
+    std::vector<std::unique_ptr<NetSession>> peers;
+    std::vector<QRandomGenerator> hands;
+    for (int p = 0; p < players; ++p) {
+        config.localIndex = p;
+        sims.push_back(std::make_unique<GameSimulation>(cols, rows));
+        sims.back()->highScore = 100 * (p + 1);    // each player's own best, as their profile has it
+        peers.push_back(std::make_unique<NetSession>(*sims.back(), config, QCoreApplication::instance()));
+        hands.emplace_back(quint32(p + 1));
+        if (!peers.back()->isOpen())
+            return 1;
+    }
+
+    // Scripted players change their mind now and then; the lives
+    // are left alone, anything a peer changes outside advance()
+    // would be a real desync
+    std::vector<NetInput> held(players);
+    QElapsedTimer clock;
+    clock.start();
+    qint64 nextNs = 0;
+    auto slowest = [&]() {
+        int f = INT_MAX;
+        for (auto &peer : peers)
+            f = qMin(f, peer->frame());
+        return f;
+    };
+    while (slowest() < steps && clock.elapsed() < 60000) {
+        QCoreApplication::processEvents();
+        if (clock.nsecsElapsed() < nextNs) {
+            QThread::usleep(200);
+            continue;
+        }
+        nextNs += stepNs;
+        for (int p = 0; p < players; ++p) {
+            if (hands[p].bounded(20) == 0)
+                held[p].buttons = quint8(hands[p].bounded(4));     // none, left, right, both
+            peers[p]->advance(held[p]);
+        }
+    }
+
+    int checkFrame = INT_MAX;
+    for (auto &peer : peers) {
+        peer->receive();
+        checkFrame = qMin(checkFrame, peer->frame() - 1 - NetSession::kHistory / 4);
+    }
+    bool agree = checkFrame >= 0;
+    quint64 reference = 0;
+    for (int p = 0; p < players && agree; ++p) {
+        quint64 hash = 0;
+        agree = peers[p]->syncHashAt(checkFrame, hash) && (p == 0 || hash == reference) && !peers[p]->desynced();
+        reference = hash;
+    }
+
+    int stalls = 0;
+    out << "players " << players << "  loss " << lossPercent << "%  latency " << latencyMs << " ms\n"
+        << "peer  steps  rollbacks  replayed  stalls  sent  dropped\n";
+    for (int p = 0; p < players; ++p) {
+        const NetSession::Stats &st = peers[p]->stats();
+        stalls = qMax(stalls, st.stalls);
+        out << qSetFieldWidth(4) << p + 1 << qSetFieldWidth(7) << peers[p]->frame()
+            << qSetFieldWidth(11) << st.rollbacks << qSetFieldWidth(10) << st.replayedSteps
+            << qSetFieldWidth(8) << st.stalls << qSetFieldWidth(6) << st.sent
+            << qSetFieldWidth(9) << st.dropped << qSetFieldWidth(0) << "\n";
+    }
+    out << "state at step " << checkFrame << (agree ? " matches on every peer" : " DIFFERS") << "\n";
+
+    bool pass = agree && stalls <= steps / 100;
+    out << (pass ? "PASS" : "FAIL") << "\n";
+    return pass ? 0 : 1;
+}
+
+/* -------------------------------------------------------------
+   BROADCAST: the frames scenario published to N viewers in
+   this process. Reports the publisher's time per frame and per
+   viewer; every viewer must end on the publisher's exact state.
+--------------------------------------------------------------*/
+static int benchBroadcast(int viewerCount)
+{
+#ifdef Q_OS_UNIX
+    // Two descriptors per viewer live in this process
+    rlimit files;
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max) {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+    }
+#endif
+    const int frames = 600;
+    QObject owner;
+    BroadcastServer server(0, &owner);
+    if (!server.isListening())
+        return 1;
+
+    std::vector<std::unique_ptr<BroadcastViewer>> viewers;
+    std::vector<std::unique_ptr<GameSimulation>> copies;
+    const int cols = qMax(40, kGateSide / kGateBox);
+    const int rows = qMax(30, kGateSide / kGateBox);
+    for (int i = 0; i < viewerCount; ++i) {
+        viewers.push_back(std::make_unique<BroadcastViewer>("127.0.0.1", server.port(), &owner));
+        copies.push_back(std::make_unique<GameSimulation>(cols, rows));
+    }
+    QElapsedTimer wait;
+    wait.start();
+    while (server.viewers() < viewerCount && wait.elapsed() < 30000)
+        QCoreApplication::processEvents();
+    if (server.viewers() < viewerCount) {
+        out << "only " << server.viewers() << " of " << viewerCount << " viewers connected\n";
+        return 1;
+    }
+
+    GameSimulation sim(cols, rows);
+    sim.reset(kGateSeed);
+    QVector<double> publishUs;
+    QElapsedTimer timer;
+    for (int frame = 0; frame < frames; ++frame) {
+        scriptFrame(sim, frame);
+        sim.step(sim.fixedDelta);
+        sim.step(sim.fixedDelta);
+
+        timer.start();
+        server.publish(sim);
+        publishUs.append(timer.nsecsElapsed() / 1000.0);
+
+        QCoreApplication::processEvents();
+        for (int i = 0; i < viewerCount; ++i)
+            viewers[i]->update(*copies[i]);
+    }
+
+    // Let the last messages land
+    const QByteArray expected = SimSnapshot::save(sim);
+    int matching = 0;
+    wait.restart();
+    while (wait.elapsed() < 10000) {
+        QCoreApplication::processEvents();
+        matching = 0;
+        for (int i = 0; i < viewerCount; ++i) {
+            viewers[i]->update(*copies[i]);
+            matching += SimSnapshot::save(*copies[i]) == expected;
+        }
+        if (matching == viewerCount)
+            break;
+    }
+
+    std::sort(publishUs.begin(), publishUs.end());
+    double p50 = percentile(publishUs, 0.5);
+    out << "viewers " << viewerCount << "  snapshot " << expected.size() << " bytes\n"
+        << "publish p50 " << p50 << " us  p99 " << percentile(publishUs, 0.99) << " us"
+        << "  per viewer " << p50 / qMax(1, viewerCount) << " us\n"
+        << "viewers in sync " << matching << " of " << viewerCount << "\n";
+    return matching == viewerCount ? 0 : 1;
+}
+
+/* -------------------------------------------------------------
+   BOTS: N simulations played by the intercept bot for a number
+   of simulated seconds, once with one batched decision pass per
+   step and once with each simulation deciding on its own.
+   Finished games restart on the next seed.
+--------------------------------------------------------------*/
+struct BotRun {
+    double ms = 0.0;
+    double planMs = 0.0;
+    int games = 0;
+    qint64 scoreTotal = 0;
+};
+
+static BotRun runBots(int simCount, int steps, bool batched)
+{
+    const int cols = qMax(40, kGateSide / kGateBox);
+    const int rows = qMax(30, kGateSide / kGateBox);
+    std::vector<std::unique_ptr<GameSimulation>> sims;
+    std::vector<InterceptBot> alone(batched ? 0 : simCount);   // each keeps its own cadence
+    BotBatch batch;
+    quint32 seed = kGateSeed;
+    for (int i = 0; i < simCount; ++i) {
+        sims.push_back(std::make_unique<GameSimulation>(cols, rows));
+        sims.back()->reset(seed++);
+        if (batched)
+            batch.add(sims.back().get());
+        else
+            sims.back()->controller = &alone[i];
+    }
+
+    const float dt = sims.front()->fixedDelta;
+    BotRun run;
+    QElapsedTimer timer;
+    timer.start();
+    for (int s = 0; s < steps; ++s) {
+        if (batched) {
+            batch.step(dt);
+        } else {
+            for (auto &sim : sims)
+                sim->step(dt);
+        }
+        for (auto &sim : sims) {
+            if (!sim->isOver())
+                continue;
+            ++run.games;
+            run.scoreTotal += sim->score;
+            sim->reset(seed++);
+        }
+    }
+    run.ms = timer.nsecsElapsed() / 1e6;
+    run.planMs = batch.planNs() / 1e6;
+    return run;
+}
+
+static int benchBots(int simCount, int seconds)
+{
+    const int steps = seconds * 120;
+    const BotRun alone = runBots(simCount, steps, false);
+    const BotRun batched = runBots(simCount, steps, true);
+
+    auto report = [](const char *name, const BotRun &run) {
+        out << name << run.ms << " ms  games " << run.games << "  mean score "
+            << (run.games ? double(run.scoreTotal) / run.games : 0.0) << "\n";
+    };
+    out << "simulations " << simCount << "  " << seconds << " s each (" << steps << " steps)\n";
+    report("one by one  ", alone);
+    report("batched     ", batched);
+    out << "batched deciding " << batched.planMs << " ms ("
+        << 100.0 * batched.planMs / qMax(1e-9, batched.ms) << "% of the run)"
+        << "  speedup " << alone.ms / qMax(1e-9, batched.ms) << "x\n";
+
+    // A bot that never scores is broken, however fast
+    return alone.scoreTotal > 0 && batched.scoreTotal > 0 ? 0 : 1;
+}
+
+/* -------------------------------------------------------------
+   TRAJECTORY: eggs in random flight (any score, type, speed,
+   gust) predicted in closed form and then stepped through the
+   real simulation until they splat. The prediction may be a
+   step off only when rounding decides it, and costs the same
+   however long the egg falls.
+--------------------------------------------------------------*/
+struct FlightCase {
+    quint32 seed;
+    int score;
+    Egg egg;
+    float wind;
+    float windTimer;
+};
+
+// The gust and the score the flight happens under
+static void setUpField(GameSimulation &sim, const FlightCase &c)
+{
+    sim.score = c.score;
+    sim.focusMode = GameSimulation::focusFor(c.score);
+    sim.windActive = c.windTimer > 0.0f;
+    sim.windStrength = c.wind;
+    sim.windTimer = c.windTimer;
+}
+
+static int benchTrajectory(int eggCount)
+{
+    const int cols = qMax(40, kGateSide / kGateBox);
+    const int rows = qMax(30, kGateSide / kGateBox);
+    const double reachRow = rows - 3.0 - 1.5;       // as Trajectory::land, basket in play
+    GameSimulation sim(cols, rows);
+    QRandomGenerator rng(11);
+
+    std::vector<FlightCase> cases;
+    for (int i = 0; i < eggCount; ++i) {
+        FlightCase c;
+        c.seed = kGateSeed + quint32(i);
+        c.score = rng.bounded(300);
+        c.egg.type = EggType(rng.bounded(int(EggType::Count)));
+        c.egg.pos = QPointF(rng.bounded(cols), rng.bounded(rows * 100 / 2) / 100.0);
+        c.egg.yVelocity = rng.bounded(2200) / 100.0f;
+        const bool gust = rng.bounded(2) == 0;
+        c.wind = gust ? (rng.bounded(2) ? 1.0f : -1.0f) * rng.bounded(200, 1000) / 100.0f : 0.0f;
+        c.windTimer = gust ? rng.bounded(1200, 2500) / 1000.0f : 0.0f;
+        cases.push_back(c);
+    }
+
+    // ---- Predict ----
+    std::vector<Landing> predicted(cases.size());
+    std::vector<double> predictedY(cases.size());
+    QElapsedTimer timer;
+    timer.start();
+    for (size_t i = 0; i < cases.size(); ++i) {
+        setUpField(sim, cases[i]);
+        predicted[i] = Trajectory::land(sim, cases[i].egg);
+        predictedY[i] = Trajectory::yAfter(Trajectory::model(sim, cases[i].egg.type), cases[i].egg.pos.y(),
+                                           cases[i].egg.yVelocity, predicted[i].splatStep);
+    }
+    const double predictNs = double(timer.nsecsElapsed()) / eggCount;
+
+    // ---- Step ----
+    int exact = 0;
+    int worstSteps = 0;
+    double worstX = 0.0;
+    double worstY = 0.0;
+    qint64 steppedSteps = 0;
+    qint64 stepNs = 0;
+    for (size_t i = 0; i < cases.size(); ++i) {
+        sim.reset(cases[i].seed);
+        setUpField(sim, cases[i]);
+        sim.timeSinceLastWind = -std::numeric_limits<float>::max();   // no new gusts
+        sim.basket.setY(-100.0);    // out of the way: the egg splats
+        sim.eggs = { cases[i].egg };
+
+        int steps = 0;
+        int reach = 0;
+        timer.start();
+        while (sim.eggs.front().state == EggState::Falling && steps < 100000) {
+            sim.lives = kMaxLives;  // eggs spawned behind it must not end the game
+            sim.step(sim.fixedDelta);
+            ++steps;
+            if (!reach && sim.eggs.front().pos.y() > reachRow)
+                reach = steps;
+        }
+        stepNs += timer.nsecsElapsed();
+        steppedSteps += steps;
+
+        const Egg &egg = sim.eggs.front();
+        const int off = qMax(qAbs(predicted[i].splatStep - steps), qAbs(predicted[i].reachStep - reach));
+        exact += off == 0;
+        worstSteps = qMax(worstSteps, off);
+        if (off == 0) {
+            worstX = qMax(worstX, qAbs(predicted[i].splatX - egg.pos.x()));
+            worstY = qMax(worstY, qAbs(predictedY[i] - egg.pos.y()));
+        }
+    }
+
+    out << "eggs " << eggCount << "  mean flight " << double(steppedSteps) / eggCount << " steps\n"
+        << "predict " << predictNs << " ns/egg  step through "
+        << stepNs / 1000.0 / eggCount << " us/egg  ("
+        << stepNs / qMax(1.0, predictNs * eggCount) << "x)\n"
+        << "landing step exact " << exact << " of " << eggCount << "  worst off by " << worstSteps
+        << "  worst x " << worstX << "  worst y " << worstY << "\n";
+
+    const bool pass = worstSteps <= 1 && exact * 100 >= eggCount * 99 && worstX < 0.01 && worstY < 0.01;
+    out << (pass ? "PASS" : "FAIL") << "\n";
+    return pass ? 0 : 1;
+}
+
+/* -------------------------------------------------------------
+   FAST-FORWARD: back-to-back games for N simulated seconds, each
+   stepped at 120 Hz and then fast-forwarded from the same seed,
+   once played by a scripted player (the pointer over a drop
+   column, moved every so often) and once by the intercept bot.
+   Every game must give the same events at the same steps, the
+   same score, lives and random generator, with the eggs and the
+   basket within rounding of the fixed steps.
+--------------------------------------------------------------*/
+struct LoggedEvent {
+    quint32 step;
+    GameEventKind kind;
+    EggType type;
+    float value;
+    float x;
+    bool operator==(const LoggedEvent &o) const
+    {
+        return step == o.step && kind == o.kind && type == o.type && value == o.value && x == o.x;
+    }
+};
+
+static std::vector<ScriptedSteer> steerScript(const GameSimulation &sim, quint32 steps)
+{
+    std::vector<ScriptedSteer> script;
+    QRandomGenerator rng(5);
+    for (quint32 step = 1; step < steps; step += quint32(rng.bounded(30, 150))) {
+        ScriptedSteer s;
+        s.step = step;
+        if (rng.bounded(5) != 0)
+            s.steer.setPointer(float(sim.dropColumns[rng.bounded(int(sim.dropColumns.size()))]));
+        script.push_back(s);
+    }
+    return script;
+}
+
+// How far apart two games' eggs and baskets are, or -1 if they
+// are not the same game
+static double drift(const GameSimulation &a, const GameSimulation &b)
+{
+    if (a.stepCount != b.stepCount || a.score != b.score || a.lives != b.lives
+        || a.rng.state != b.rng.state || a.eggs.size() != b.eggs.size())
+        return -1.0;
+    double worst = std::abs(a.basket.x() - b.basket.x());
+    for (int i = 0; i < a.eggs.size(); ++i) {
+        if (a.eggs[i].state != b.eggs[i].state || a.eggs[i].type != b.eggs[i].type)
+            return -1.0;
+        worst = qMax(worst, std::abs(a.eggs[i].pos.x() - b.eggs[i].pos.x()));
+        worst = qMax(worst, std::abs(a.eggs[i].pos.y() - b.eggs[i].pos.y()));
+    }
+    return worst;
+}
+
+struct FastForwardRun {
+    qint64 fixedNs = 0;
+    qint64 fastNs = 0;
+    qint64 fullSteps = 0;
+    qint64 coastedSteps = 0;
+    quint32 played = 0;
+    int games = 0;
+    int differing = 0;
+    double worstDrift = 0.0;
+};
+
+static FastForwardRun runFastForward(int seconds, bool bot)
+{
+    const int cols = qMax(40, kGateSide / kGateBox);
+    const int rows = qMax(30, kGateSide / kGateBox);
+    const quint32 budget = quint32(seconds) * 120;
+    const quint32 gameCap = 120 * 600;      // a game is cut at 10 minutes
+    const std::vector<ScriptedSteer> script = bot ? std::vector<ScriptedSteer>()
+                                                  : steerScript(GameSimulation(cols, rows), gameCap);
+
+    FastForward fast;
+    FastForwardRun run;
+    QElapsedTimer timer;
+    while (run.played < budget) {
+        const quint32 until = qMin(gameCap, budget - run.played);
+        const quint32 seed = kGateSeed + quint32(run.games);
+        GameSimulation fixed(cols, rows);
+        GameSimulation skipped(cols, rows);
+        InterceptBot fixedBot;
+        InterceptBot skippedBot;
+        fixed.reset(seed);
+        skipped.reset(seed);
+        if (bot) {
+            fixed.controller = &fixedBot;
+            skipped.controller = &skippedBot;
+        }
+        std::vector<LoggedEvent> fixedLog;
+        std::vector<LoggedEvent> skippedLog;
+        fixed.onEvent = [&fixed, &fixedLog](GameEventKind kind, EggType type, float value, float x) {
+            fixedLog.push_back({ fixed.stepCount, kind, type, value, x });
+        };
+        skipped.onEvent = [&skipped, &skippedLog](GameEventKind kind, EggType type, float value, float x) {
+            skippedLog.push_back({ skipped.stepCount, kind, type, value, x });
+        };
+
+        size_t next = 0;
+        timer.start();
+        while (!fixed.isOver() && fixed.stepCount < until) {
+            if (next < script.size() && script[next].step == fixed.stepCount + 1)
+                fixed.steer = script[next++].steer;
+            fixed.step(fixed.fixedDelta);
+        }
+        run.fixedNs += timer.nsecsElapsed();
+
+        timer.start();
+        fast.run(skipped, until, script);
+        run.fastNs += timer.nsecsElapsed();
+
+        const double apart = fixedLog == skippedLog ? drift(fixed, skipped) : -1.0;
+        if (apart < 0.0 || apart >= 0.01) {
+            if (run.differing++ < 5)
+                out << "game " << run.games << " (seed " << seed << ") differs: steps "
+                    << fixed.stepCount << " / " << skipped.stepCount << "  events " << int(fixedLog.size())
+                    << " / " << int(skippedLog.size()) << "  drift " << apart << "\n";
+        } else {
+            run.worstDrift = qMax(run.worstDrift, apart);
+        }
+        run.played += qMax<quint32>(1, fixed.stepCount);
+        ++run.games;
+    }
+    run.fullSteps = fast.stepped();
+    run.coastedSteps = fast.coasted();
+    return run;
+}
+
+static int benchFastForward(int seconds)
+{
+    auto report = [](const char *name, const FastForwardRun &run) {
+        const qint64 total = run.fullSteps + run.coastedSteps;
+        out << name << " simulated " << run.played / 120.0 << " s in " << run.games << " games\n"
+            << "  fixed steps " << run.fixedNs / 1e6 << " ms  fast-forward " << run.fastNs / 1e6 << " ms  ("
+            << double(run.fixedNs) / qMax<qint64>(1, run.fastNs) << "x)\n"
+            << "  full steps " << run.fullSteps << " of " << total << " ("
+            << 100.0 * run.fullSteps / qMax<qint64>(1, total) << "%)  worst drift " << run.worstDrift << "\n"
+            << "  games differing " << run.differing << " of " << run.games << "\n";
+    };
+    const FastForwardRun scripted = runFastForward(seconds, false);
+    const FastForwardRun bot = runFastForward(seconds, true);
+    report("scripted", scripted);
+    report("bot     ", bot);
+    return scripted.differing == 0 && bot.differing == 0 ? 0 : 1;
+}
+
+/* -------------------------------------------------------------
+   ENTRY
+--------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+    // Frames draws text into images, which needs a GUI application;
+    // headless unless a platform was asked for
+    const bool gui = argc >= 2 && (qstrcmp(argv[1], "frames") == 0 || qstrcmp(argv[1], "golden") == 0);
+    if (gui && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    std::unique_ptr<QCoreApplication> app(gui ? new QGuiApplication(argc, argv)
+                                              : new QCoreApplication(argc, argv));
+    QStringList args = app->arguments().mid(1);
+
+    if (args.size() >= 3 && args[0] == "parse")
+        return benchParse(args[1], args[2].toInt());
+    if (args.size() >= 3 && args[0] == "backend")
+        return benchBackend(args[1], args[2].toInt());
+    if (args.size() >= 2 && args[0] == "http")
+        return benchHttp(args[1].toInt());
+    if (args.size() >= 2 && args[0] == "raster")
+        return benchRaster(qMax(1, args[1].toInt()));
+    if (args.size() >= 3 && args[0] == "frames")
+        return benchFrames(args[1], args[2], args.size() >= 4 ? args[3].toDouble() : 10.0);
+    if (args.size() >= 3 && args[0] == "golden")
+        return benchGolden(args[1], args[2], args.size() >= 4 ? args[3].toDouble() : 0.05);
+    if (args.size() >= 2 && args[0] == "particles")
+        return benchParticles(qMax(1, args[1].toInt()));
+    if (args.size() >= 1 && args[0] == "snapshot")
+        return benchSnapshot();
+    if (args.size() >= 2 && args[0] == "netplay")
+        return benchNetplay(args[1].toInt(), args.size() >= 3 ? args[2].toInt() : 5,
+                            args.size() >= 4 ? args[3].toInt() : 100);
+    if (args.size() >= 2 && args[0] == "broadcast")
+        return benchBroadcast(qMax(1, args[1].toInt()));
+    if (args.size() >= 3 && args[0] == "bots")
+        return benchBots(qMax(1, args[1].toInt()), qMax(1, args[2].toInt()));
+    if (args.size() >= 2 && args[0] == "trajectory")
+        return benchTrajectory(qMax(1, args[1].toInt()));
+    if (args.size() >= 2 && args[0] == "fastforward")
+        return benchFastForward(qMax(1, args[1].toInt()));
+    if (args.size() >= 2 && args[0] == "recount")
+        return recountLeaderboard(args[1]);
+
+    out << "usage:\n"
+        << "  eggbench parse <stream|dom> <megabytes>\n"
+        << "  eggbench backend <memory|local> <entries>\n"
+        << "  eggbench http <submissions>\n"
+        << "  eggbench raster <iterations>\n"
+        << "  eggbench frames <check|record> <baseline.json> [threshold %]\n"
+        << "  eggbench golden <check|record> <directory> [max differing %]\n"
+        << "  eggbench particles <bursts per step>\n"
+        << "  eggbench snapshot\n"
+        << "  eggbench netplay <players> [loss %] [latency ms]\n"
+        << "  eggbench broadcast <viewers>\n"
+        << "  eggbench bots <simulations> <seconds>\n"
+        << "  eggbench trajectory <eggs>\n"
+        << "  eggbench fastforward <seconds>\n"
+        << "  eggbench recount <leaderboard url>\n";
+    return 1;
+}
@@ -0,0 +1,227 @@
+#include "eggraster.h"
+
+#include <QHash>
+#include <QImage>
+#include <QtMath>
+#include <algorithm>
+
+static const int kMaxImageSide = 1024;   // larger eggs are drawn from the region
+
+/* -------------------------------------------------------------
+   OUTLINE -> SPANS
+   Same outline and even/odd pairing as the original per-cell
+   plotter, only the output is runs instead of cells.
+--------------------------------------------------------------*/
+QVector<EggSpan> EggRaster::rasterize(int box)
+{
+    QVector<QPoint> boundary;
+
+    // ---- SEMICIRCLE BOTTOM (midpoint circle) ----
+    int r = box;
+    int x = 0;
+    int y = r;
+    int d = 1 - r;
+
+    while (x <= y)
+    {
+        int px[4] = { x,  y, -x, -y };
+        int py[4] = { y,  x,  y,  x };
+
+        for (int i = 0; i < 4; i++)
+            boundary.push_back({px[i], py[i]});
+
+        x++;
+        if (d < 0) d += 2*x + 1;
+        else { y--; d += 2*(x - y) + 1; }
+    }
+
+    // ---- TOP ELLIPSE (midpoint ellipse) ----
+    int rx = box;
+    int ry = box * 1.5;
+    int rx2 = rx * rx;
+    int ry2 = ry * ry;
+    int ex = 0;
+    int ey = ry;
+
+    float d1 = ry2 - rx2 * ry + (0.25f * rx2);
+    int dx = 2 * ry2 * ex;
+    int dy = 2 * rx2 * ey;
+
+    while (dx < dy)
+    {
+        boundary.push_back({ex, -ey});
+        boundary.push_back({-ex, -ey});
+
+        if (d1 < 0) {
+            ex++;
+            dx += 2*ry2;
+            d1 += dx + ry2;
+        } else {
+            ex++; ey--;
+            dx += 2*ry2;
+            dy -= 2*rx2;
+            d1 += dx - dy + ry2;
+        }
+    }
+
+    float d2 =
+        (ry2)*(ex+0.5f)*(ex+0.5f) +
+        (rx2)*(ey-1)*(ey-1) -
+        (rx2*ry2);
+
+    while (ey >= 0)
+    {
+        boundary.push_back({ex, -ey});
+        boundary.push_back({-ex, -ey});
+
+        if (d2 > 0) {
+            ey--;
+            dy -= 2*rx2;
+            d2 += rx2 - dy;
+        } else {
+            ey--; ex++;
+            dx += 2*ry2;
+            dy -= 2*rx2;
+            d2 += dx - dy + rx2;
+        }
+    }
+
+    // ---- PAIR BOUNDARY POINTS PER SCANLINE, MERGE INTO RUNS ----
+    std::sort(boundary.begin(), boundary.end(),
+              [](const QPoint &a, const QPoint &b){
+                  return (a.y() == b.y()) ? a.x() < b.x() : a.y() < b.y();
+              });
+
+    QVector<EggSpan> spans;
+    int i = 0;
+    while (i < boundary.size())
+    {
+        int row = boundary[i].y();
+        int end = i;
+        while (end < boundary.size() && boundary[end].y() == row)
+            ++end;
+
+        // Pairs come out sorted by x0, so overlapping or touching ones are adjacent
+        int first = spans.size();
+        for (int k = i; k + 1 < end; k += 2) {
+            int x0 = boundary[k].x();
+            int x1 = boundary[k + 1].x();
+            if (spans.size() > first && x0 <= spans.last().x1 + 1)
+                spans.last().x1 = std::max(spans.last().x1, x1);
+            else
+                spans.push_back({row, x0, x1});
+        }
+        i = end;
+    }
+    return spans;
+}
+
+/* -------------------------------------------------------------
+   CACHE
+--------------------------------------------------------------*/
+namespace {
+
+struct CachedEgg {
+    QVector<EggSpan> spans;
+    QRegion region;      // pixels, origin at the centre cell
+    QImage image;        // null when the egg is too large
+    QPoint imageOrigin;  // top-left of image relative to the centre cell
+};
+
+const CachedEgg &cachedEgg(int box)
+{
+    static QHash<int, CachedEgg> cache;
+
+    auto it = cache.constFind(box);
+    if (it != cache.constEnd())
+        return *it;
+
+    CachedEgg egg;
+    egg.spans = EggRaster::rasterize(box);
+
+    QVector<QRect> rects;
+    rects.reserve(egg.spans.size());
+    for (const EggSpan &s : egg.spans)
+        rects.push_back(QRect(s.x0 * box, s.y * box, (s.x1 - s.x0 + 1) * box, box));
+    egg.region.setRects(rects.constData(), int(rects.size()));
+
+    QRect bounds = egg.region.boundingRect();
+    if (!bounds.isEmpty() && bounds.width() <= kMaxImageSide && bounds.height() <= kMaxImageSide) {
+        egg.image = QImage(bounds.size(), QImage::Format_ARGB32_Premultiplied);
+        egg.image.fill(Qt::transparent);
+
+        QPainter ip(&egg.image);
+        ip.translate(-bounds.topLeft());
+        for (const QRect &rc : egg.region)
+            ip.fillRect(rc, Qt::white);
+        egg.imageOrigin = bounds.topLeft();
+    }
+
+    return *cache.insert(box, egg);
+}
+
+}
+
+const QVector<EggSpan> &EggRaster::spans(int box)
+{
+    return cachedEgg(box).spans;
+}
+
+const QRegion &EggRaster::region(int box)
+{
+    return cachedEgg(box).region;
+}
+
+void EggRaster::draw(QPainter &p, int cx, int cy, int box)
+{
+    const CachedEgg &egg = cachedEgg(box);
+    QPoint centre(cx * box, cy * box);
+
+    if (!egg.image.isNull()) {
+        p.drawImage(centre + egg.imageOrigin, egg.image);
+        return;
+    }
+
+    for (const QRect &rc : egg.region)
+        p.fillRect(rc.translated(centre), Qt::white);
+}
+
+/* -------------------------------------------------------------
+   IN-GAME EGG (per-pixel plotter, also used to build sprites)
+--------------------------------------------------------------*/
+void EggRaster::paintPixelEgg(QPainter &p, QPointF center, float w, float h,
+                              const QColor &fill, const QColor &outline)
+{
+    int step = 1; // pixel step
+
+    // Lambda to draw a pixel
+    auto plot = [&](int gx, int gy) {
+        p.fillRect(center.x() + gx, center.y() + gy, step, step, fill);
+    };
+
+    for (int yi = -h / 2; yi <= h / 2; yi += step)
+    {
+        float yf = float(yi) / (h / 2);
+
+        float modifier = (yf < 0) ? (1.0f - 0.3f * yf * yf) : (1.0f + 0.1f * yf);
+
+        int xSpan = int((w / 2) * sqrt(1 - yf * yf) * modifier);
+
+        for (int xi = -xSpan; xi <= xSpan; xi += step)
+        {
+            plot(xi, yi);
+        }
+    }
+
+    p.setBrush(outline);
+    for (int yi = -h / 2; yi <= h / 2; yi += step)
+    {
+        float yf = float(yi) / (h / 2);
+        float modifier = (yf < 0) ? (1.0f - 0.3f * yf * yf) : (1.0f + 0.1f * yf);
+        int xSpan = int((w / 2) * sqrt(1 - yf * yf) * modifier);
+
+        // left & right edges
+        p.fillRect(center.x() - xSpan, center.y() + yi, step, step, outline);
+        p.fillRect(center.x() + xSpan, center.y() + yi, step, step, outline);
+    }
+}
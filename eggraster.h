@@ -0,0 +1,43 @@
+#ifndef EGGRASTER_H
+#define EGGRASTER_H
+
+#include <QColor>
+#include <QPainter>
+#include <QRegion>
+#include <QVector>
+
+// ======================================================
+// Pixel-art egg: midpoint circle bottom, midpoint ellipse top
+//
+// The outline depends only on the cell size, so each size is
+// rasterized once into run-length scanline spans and cached.
+// Drawing is then one image blit (or one region fill for
+// sizes too large to keep as an image).
+// ======================================================
+struct EggSpan {
+    int y;      // cells, relative to the egg centre
+    int x0;     // first filled cell
+    int x1;     // last filled cell (inclusive)
+};
+
+namespace EggRaster {
+
+// Sorted by y then x, non-overlapping; computed on every call
+QVector<EggSpan> rasterize(int box);
+
+// Memoized per box size
+const QVector<EggSpan> &spans(int box);
+// Spans as box-sized pixel cells, origin at the egg centre cell
+const QRegion &region(int box);
+
+// Draws the egg centred on grid cell (cx, cy), cells are `box` pixels
+void draw(QPainter &p, int cx, int cy, int box);
+
+// The in-game egg: w x h ellipse, pointier on top, one painter unit
+// per pixel, filled with `fill` and edged with `outline`
+void paintPixelEgg(QPainter &p, QPointF center, float w, float h,
+                   const QColor &fill, const QColor &outline);
+
+}
+
+#endif // EGGRASTER_H
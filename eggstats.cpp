@@ -0,0 +1,164 @@
+// ======================================================
+// eggstats: aggregate many session logs (*.egglog) in parallel
+//
+//   eggstats <file-or-dir> [...]
+// ======================================================
+#include "analytics.h"
+#include "eggtraits.h"
+
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QtConcurrent>
+
+static constexpr int kEggTypes = int(EggType::Count);
+
+struct SessionStats {
+    qint64 sessions = 0;
+    qint64 badFiles = 0;
+    qint64 events = 0;
+    qint64 perKind[int(GameEventKind::Count)] = {};
+    qint64 catches[kEggTypes] = {};
+    qint64 splats[kEggTypes] = {};
+    qint64 totalFinalScore = 0;
+    qint32 bestScore = 0;
+    qint64 focusMs = 0;
+    qint64 windMs = 0;
+    qint64 playMs = 0;
+};
+
+static SessionStats scanFile(const QString &path)
+{
+    SessionStats stats;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        stats.badFiles = 1;
+        return stats;
+    }
+    uchar *mem = file.map(0, file.size());
+    if (!mem) {
+        stats.badFiles = 1;
+        return stats;
+    }
+
+    quint32 focusStart = 0, windStart = 0, lastTime = 0;
+    qint32 lastScore = 0;
+    bool inFocus = false, inWind = false;
+
+    bool ok = Analytics::readChunks(mem, file.size(), [&](const EventChunk &chunk) {
+        for (int i = 0; i < chunk.size(); ++i) {
+            GameEventKind kind = GameEventKind(chunk.kind[i]);
+            int egg = qMin<int>(chunk.eggType[i], kEggTypes - 1);
+            quint32 t = chunk.timeMs[i];
+
+            stats.perKind[qMin<int>(int(kind), int(GameEventKind::Count) - 1)]++;
+            switch (kind) {
+            case GameEventKind::Catch:      stats.catches[egg]++; break;
+            case GameEventKind::Splat:      stats.splats[egg]++; break;
+            case GameEventKind::FocusEnter: focusStart = t; inFocus = true; break;
+            case GameEventKind::FocusExit:  if (inFocus) stats.focusMs += t - focusStart; inFocus = false; break;
+            case GameEventKind::WindStart:  windStart = t; inWind = true; break;
+            case GameEventKind::WindEnd:    if (inWind) stats.windMs += t - windStart; inWind = false; break;
+            default: break;
+            }
+
+            lastTime = t;
+            lastScore = chunk.score[i];
+        }
+        stats.events += chunk.size();
+    });
+
+    file.unmap(mem);
+
+    if (!ok) {
+        stats.badFiles = 1;
+        return stats;
+    }
+
+    if (inFocus) stats.focusMs += lastTime - focusStart;
+    if (inWind)  stats.windMs += lastTime - windStart;
+
+    stats.sessions = 1;
+    stats.playMs = lastTime;
+    stats.totalFinalScore = lastScore;
+    stats.bestScore = lastScore;
+    return stats;
+}
+
+static void mergeStats(SessionStats &total, const SessionStats &s)
+{
+    total.sessions += s.sessions;
+    total.badFiles += s.badFiles;
+    total.events += s.events;
+    for (int k = 0; k < int(GameEventKind::Count); ++k)
+        total.perKind[k] += s.perKind[k];
+    for (int e = 0; e < kEggTypes; ++e) {
+        total.catches[e] += s.catches[e];
+        total.splats[e] += s.splats[e];
+    }
+    total.totalFinalScore += s.totalFinalScore;
+    total.bestScore = qMax(total.bestScore, s.bestScore);
+    total.focusMs += s.focusMs;
+    total.windMs += s.windMs;
+    total.playMs += s.playMs;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QStringList args = app.arguments().mid(1);
+    if (args.isEmpty()) {
+        out << "usage: eggstats <file-or-dir> [...]\n";
+        return 1;
+    }
+
+    QStringList files;
+    for (const QString &arg : args) {
+        if (QFileInfo(arg).isDir()) {
+            QDirIterator it(arg, {"*.egglog"}, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext())
+                files << it.next();
+        } else {
+            files << arg;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    SessionStats total = QtConcurrent::blockingMappedReduced<SessionStats>(
+        files, scanFile, mergeStats, QtConcurrent::UnorderedReduce);
+
+    static const char *kindNames[] = {
+        "catch", "splat", "life+", "life-", "wind start", "wind end", "focus enter", "focus exit"
+    };
+    static const char *eggNames[] = { "normal", "bad", "life" };
+    static_assert(sizeof(eggNames) / sizeof(eggNames[0]) == kEggTypes, "one name per egg type");
+
+    out << "files:      " << files.size() << " (" << total.badFiles << " unreadable)\n";
+    out << "sessions:   " << total.sessions << "\n";
+    out << "events:     " << total.events << "\n";
+    out << "best score: " << total.bestScore << "\n";
+    if (total.sessions > 0) {
+        out << "avg score:  " << double(total.totalFinalScore) / total.sessions << "\n";
+        out << "avg length: " << total.playMs / 1000.0 / total.sessions << " s\n";
+    }
+    out << "wind time:  " << total.windMs / 1000.0 << " s\n";
+    out << "focus time: " << total.focusMs / 1000.0 << " s\n\n";
+
+    for (int k = 0; k < int(GameEventKind::Count); ++k)
+        out << QString("%1 %2\n").arg(kindNames[k], -12).arg(total.perKind[k]);
+    out << "\n";
+    for (int e = 0; e < kEggTypes; ++e)
+        out << QString("%1 caught %2  splat %3\n").arg(eggNames[e], -7)
+                   .arg(total.catches[e]).arg(total.splats[e]);
+
+    out << "\nscanned in " << timer.elapsed() << " ms\n";
+    return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef EGGTRAITS_H
+#define EGGTRAITS_H
+
+#include <QtGlobal>
+
+// ======================================================
+// EGG TYPES
+// ======================================================
+enum class EggType : quint8 {
+    Normal,
+    Bad,
+    Life,
+    Count
+};
+
+enum class EggState : quint8 {
+    Falling,
+    Caught,
+    Splat
+};
+
+// ======================================================
+// PER-TYPE BEHAVIOUR TABLE
+// ======================================================
+// Everything that differs between egg types lives here so the
+// physics loop can index instead of branching. New types only
+// need a row below (and a spawn weight).
+struct EggTraits {
+    float gravityScale;     // multiplier on baseGravity
+    int   catchScore[2];    // score delta on catch, [normal, focus]
+    int   catchLives;       // lives delta on catch
+    int   splatLives;       // lives delta when it hits the ground
+    QRgb  flash;            // screen flash on catch, 0 = none
+    QRgb  tint;             // visual color
+    int   spawnWeight;      // relative spawn chance (out of 100)
+};
+
+constexpr EggTraits kEggTraits[int(EggType::Count)] = {
+    // gravity  score      catch  splat  flash        tint        weight
+    { 1.0f,    { 2, 5 },   0,    -1,    0,           0xffffffff,  75 },  // Normal
+    { 1.2f,    {-2, 0 },  -1,     0,    0xffff0000,  0xffc83232,  20 },  // Bad
+    { 0.5f,    { 2, 5 },   1,    -1,    0xff00ff00,  0xffff69b4,   5 },  // Life
+};
+
+constexpr const EggTraits &eggTraits(EggType type)
+{
+    return kEggTraits[int(type)];
+}
+
+// ======================================================
+// PER-MODE TUNING (normal play vs. focus mode)
+// ======================================================
+template <bool Focus>
+struct ModeTraits {
+    static constexpr float gravityScale   = Focus ? 1.15f : 1.0f;
+    static constexpr float fallSpeedScale = Focus ? 1.15f : 1.0f;
+    static constexpr float minSpawn       = Focus ? 0.5f  : 0.6f;
+    static constexpr float spawnBonus     = Focus ? 0.05f : 0.0f;
+    static constexpr float windMin        = Focus ? 4.0f  : 2.0f;
+    static constexpr float windMax        = Focus ? 10.0f : 6.0f;
+};
+
+constexpr int kMaxLives = 5;
+
+#endif // EGGTRAITS_H
@@ -0,0 +1,125 @@
+#include "fastforward.h"
+#include "trajectory.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Float and double disagree by less than this over a flight
+static const double kSlack = 0.05;
+
+void FastForward::run(GameSimulation &sim, quint32 untilStep, const std::vector<ScriptedSteer> &script)
+{
+    queue = decltype(queue)();
+    endStep = untilStep + 1;
+    // The script is in step order: only its next entry waits in the queue
+    size_t nextSteer = sim.controller ? script.size() : 0;
+    while (nextSteer < script.size() && script[nextSteer].step <= sim.stepCount)
+        ++nextSteer;
+    auto queueSteer = [&]() {
+        if (nextSteer < script.size() && script[nextSteer].step <= untilStep)
+            push(script[nextSteer].step, Kind::Steer, quint32(nextSteer));
+    };
+    queueSteer();
+    push(endStep, Kind::End, 0);
+
+    bool planned = false;
+    while (!sim.isOver() && sim.stepCount < untilStep) {
+        if (!planned) {
+            plan(sim);
+            planned = true;
+        }
+        const Pending next = queue.top();
+        queue.pop();
+        if (next.kind == Kind::Step && next.tag != generation)
+            continue;           // planned before the last full step
+
+        const int quiet = int(next.step - 1 - sim.stepCount);
+        sim.coast(quiet);
+        coastedSteps += qMax(0, quiet);
+
+        if (next.kind == Kind::Steer) {
+            sim.steer = script[next.tag].steer;
+            ++nextSteer;
+            queueSteer();
+        } else if (next.kind == Kind::Step) {
+            sim.step(sim.fixedDelta);
+            ++fullSteps;
+            planned = false;
+        }
+    }
+}
+
+void FastForward::plan(const GameSimulation &sim)
+{
+    ++generation;
+    const quint32 now = sim.stepCount;
+    const float dt = sim.fixedDelta;
+    quint32 soonest = endStep;
+    auto due = [&](int steps) {
+        const quint32 at = now + quint32(qMax(1, steps));
+        if (at >= endStep)
+            return;             // past the run: End comes first
+        push(at, Kind::Step, generation);
+        soonest = qMin(soonest, at);
+    };
+
+    // ---------- FOCUS: step() turns it the step after the score ----------
+    if (GameSimulation::focusFor(sim.score) != sim.focusMode)
+        due(1);
+
+    // ---------- CONTROLLER: its next decision ----------
+    if (sim.controller)
+        due(sim.controller->holdSteps(sim) + 1);
+
+    // ---------- SPAWN ----------
+    // The coming step checks the pace set before it; after a catch
+    // the steps after it check the new one
+    const int most = int(endStep - now);
+    const float pace = GameSimulation::spawnIntervalFor(sim.score, sim.focusMode);
+    if (sim.globalSpawnTimer + dt >= sim.spawnInterval)
+        due(1);
+    else
+        due(qMax(2, Trajectory::stepsUntil(sim.globalSpawnTimer, dt, pace, most)));
+
+    // ---------- GUST ENDING ----------
+    const int gustSteps = Trajectory::windSteps(sim);
+    if (sim.windActive)
+        due(gustSteps + 1);
+
+    // ---------- EGGS ----------
+    // Caught with its centre within 8.5 of the basket's. The basket
+    // never moves faster than basketStep (blending toward at most
+    // basketMaxVel) and the wind drifts the egg by windStep, so the
+    // gap between them closes by at most the two a step: until it
+    // can have closed, the egg only matters when it splats.
+    const double basketStep = qMax(std::abs(sim.basketXVelocity), sim.basketMaxVel) * dt;
+    const double windStep = sim.windActive ? std::abs(sim.windStrength * dt) : 0.0;
+    const double bx = sim.basket.x();
+    for (const Egg &egg : sim.eggs) {
+        if (egg.state != EggState::Falling)
+            continue;           // bursts and fades out while coasting
+        const Landing landing = Trajectory::land(sim, egg, gustSteps);
+        const double gap = std::abs(egg.pos.x() + 0.5 - bx) - 8.5 - kSlack;
+        const int closed = gap <= 0.0 ? 1 : int(std::ceil(gap / (basketStep + windStep)));
+        const int reach = qMax(closed, landing.reachStep - (landing.reachClear ? 0 : 1));
+        const int splat = landing.splatStep - (landing.splatClear ? 0 : 1);
+        due(qMin(reach, splat));
+    }
+
+    // ---------- GUST STARTING ----------
+    // Past the cooldown each step rolls once, and nothing else
+    // draws until the next full step, so a copy of the generator
+    // shows which roll succeeds; only the steps up to the soonest
+    // event are rolled
+    if (!sim.windActive) {
+        const quint32 rollsFrom = now + quint32(Trajectory::stepsUntil(sim.timeSinceLastWind, dt,
+                                                                        sim.windCooldown, most));
+        SimRandom roll = sim.rng;
+        for (quint32 at = rollsFrom; at < soonest; ++at) {
+            if (roll.bounded(1000) < 2) {
+                due(int(at - now));
+                break;
+            }
+        }
+    }
+}
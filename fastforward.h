@@ -0,0 +1,77 @@
+#ifndef FASTFORWARD_H
+#define FASTFORWARD_H
+
+#include <QtGlobal>
+#include <queue>
+#include <vector>
+
+#include "gamesim.h"
+
+// Steer held from a given step on, for scripted headless runs
+struct ScriptedSteer {
+    quint32 step;           // the first step (stepCount) it applies to
+    SteerState steer;
+};
+
+// ======================================================
+// Fast-forward for headless runs
+//
+// Most fixed steps only count timers down and move the eggs
+// along. The next step that can decide anything is known in
+// advance: the spawn timer, the gust ending or (past its
+// cooldown, reading ahead in a copy of the random generator)
+// the gust that starts, each egg reaching the basket or the
+// ground (Trajectory; a step early when the crossing is within
+// rounding, and never before the basket could have closed the
+// gap), the scripted steers, and the controller's next
+// decision (BasketController::holdSteps). They wait in a queue
+// by step; the simulation jumps straight to the earliest
+// (GameSimulation::coast, in closed form) and takes that one
+// as a full step(). After a full step the simulation's own
+// events are planned again, since a catch changes gravity and
+// a spawn adds an egg; the stale ones left in the queue are
+// dropped as they come up.
+//
+// Against fixed stepping the game is the same event for event:
+// the same spawns, gusts, catches, splats and lives at the same
+// steps, so the same score. The timers and the random generator
+// match to the bit; the eggs and the basket are jumped in
+// doubles, within rounding of the floats fixed steps add, which
+// could only show if an egg met the basket's edge within that
+// rounding. The wind dust and streaks are not made; splat
+// bursts are, from their own generator.
+// ======================================================
+class FastForward
+{
+public:
+    // Runs until stepCount reaches untilStep or the game ends. The
+    // script's steers (in step order) drive a simulation with no
+    // controller; with one, the controller steers.
+    void run(GameSimulation &sim, quint32 untilStep, const std::vector<ScriptedSteer> &script = {});
+
+    qint64 stepped() const { return fullSteps; }
+    qint64 coasted() const { return coastedSteps; }
+
+private:
+    enum class Kind : quint8 { Steer, Step, End };     // same step: in this order
+    struct Pending {
+        quint32 step;
+        Kind kind;
+        quint32 tag;        // script index, or plan generation
+        bool operator>(const Pending &o) const
+        {
+            return step != o.step ? step > o.step : kind > o.kind;
+        }
+    };
+
+    void plan(const GameSimulation &sim);
+    void push(quint32 step, Kind kind, quint32 tag) { queue.push({ step, kind, tag }); }
+
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> queue;
+    quint32 endStep = 0;    // one past the last step to run
+    quint32 generation = 0;
+    qint64 fullSteps = 0;
+    qint64 coastedSteps = 0;
+};
+
+#endif // FASTFORWARD_H
@@ -0,0 +1,344 @@
+#include "gamerenderer.h"
+#include "eggraster.h"
+
+#include <QFontMetricsF>
+#include <QPen>
+#include <algorithm>
+
+GameRenderer::GameRenderer(int gridSize, int gridBox)
+    : grid_size(gridSize),
+    grid_box(gridBox)
+{
+    for (int t = 0; t < int(EggType::Count); ++t)
+        particlePalette[t] = QColor::fromRgba(kEggTraits[t].tint);
+}
+
+void GameRenderer::setAssets(std::shared_ptr<const RenderAssets> assets)
+{
+    renderAssets = std::move(assets);
+    backgroundPix = QPixmap::fromImage(renderAssets->background);
+}
+
+// ======================================================
+// RENDER CACHE (rebuilt only when the canvas changes)
+// ======================================================
+
+void GameRenderer::setCanvas(int side, qreal dpr)
+{
+    canvasSide = side;
+    canvasDpr = dpr;
+    canvasScale = qreal(side) / grid_size;
+
+    scoreFont = QFont("Comic Sans MS", 24, QFont::Bold);
+    highScoreFont = QFont("Arial", 18, QFont::Bold);
+    bannerFont = QFont("Arial", 18, QFont::Bold);
+    windFont = QFont("Arial", grid_box * 0.9f, QFont::Bold);
+    windAscent = QFontMetricsF(windFont).ascent();
+    scoreAscent = QFontMetricsF(scoreFont).ascent();
+    highScoreAscent = QFontMetricsF(highScoreFont).ascent();
+    scoreText.setPerformanceHint(QStaticText::AggressiveCaching);
+    highScoreText.setPerformanceHint(QStaticText::AggressiveCaching);
+
+    // force the HUD to re-layout with the new fonts
+    hudScore = std::numeric_limits<int>::min();
+    hudHighScore = std::numeric_limits<int>::min();
+    hudLives = -1;
+
+    windArrowRight.setText(">>>>");
+    windArrowLeft.setText("<<<<");
+    focusBanner.setText("FOCUS MODE  x5 SCORE");
+    windArrowRight.prepare(QTransform::fromScale(canvasScale, canvasScale), windFont);
+    windArrowLeft.prepare(QTransform::fromScale(canvasScale, canvasScale), windFont);
+    focusBanner.prepare(QTransform::fromScale(canvasScale, canvasScale), bannerFont);
+
+    const double heartSize = 24;
+    heartPath = QPainterPath();
+    heartPath.moveTo(heartSize / 2.0, heartSize / 5.0);
+    heartPath.cubicTo(heartSize / 2.0, 0, 0, 0, 0, heartSize / 3.0);
+    heartPath.cubicTo(0, heartSize * 0.8, heartSize / 2.0, heartSize,
+                      heartSize / 2.0, heartSize * 0.9);
+    heartPath.cubicTo(heartSize / 2.0, heartSize, heartSize,
+                      heartSize * 0.8, heartSize, heartSize / 3.0);
+    heartPath.cubicTo(heartSize, 0, heartSize / 2.0, 0,
+                      heartSize / 2.0, heartSize / 5.0);
+
+    const int basketWidthCells = 16;
+    const int basketHeightCells = 6;
+    rimPath = QPainterPath();
+    rimPath.moveTo(-basketWidthCells / 2.0f * grid_box, 0);
+    rimPath.quadTo(QPointF(0, -basketHeightCells * 0.5f * grid_box),
+                   QPointF(basketWidthCells / 2.0f * grid_box, 0));
+}
+
+void GameRenderer::updateHudCache(const GameSimulation &sim)
+{
+    if (sim.score != hudScore) {
+        hudScore = sim.score;
+        scoreText.setText(QString("Score: %1").arg(sim.score));
+        scoreText.prepare(QTransform::fromScale(canvasScale, canvasScale), scoreFont);
+    }
+
+    if (sim.highScore != hudHighScore) {
+        hudHighScore = sim.highScore;
+        highScoreText.setText(QString("High Score: %1").arg(sim.highScore));
+        highScoreText.prepare(QTransform::fromScale(canvasScale, canvasScale), highScoreFont);
+    }
+
+    if (sim.lives != hudLives) {
+        hudLives = sim.lives;
+        const int heartSize = 24;
+        heartOrigins.resize(qMax(0, sim.lives));
+        for (int i = 0; i < heartOrigins.size(); ++i)
+            heartOrigins[i] = QPointF(grid_size - 40 - i * (heartSize + 5), 20);
+    }
+}
+
+// ======================================================
+// EGG DRAWING UTILITY
+// ======================================================
+
+void GameRenderer::drawEggShape(QPainter &p, const Egg &egg, float renderY, float cellSize)
+{
+    p.setRenderHint(QPainter::Antialiasing, false); // pixelated look
+
+    QPointF center((egg.pos.x() + 0.5f) * cellSize, (renderY + 0.5f) * cellSize);
+
+    float baseW = cellSize * 2.5f * 1.5f; // width scaling
+    float baseH = cellSize * 2.5f * 2.0f; // height scaling
+    float w = baseW * egg.scale;
+    float h = baseH * egg.scale;
+
+    QColor fillColor = QColor::fromRgba(eggTraits(egg.type).tint);
+    fillColor.setAlphaF(egg.alpha);
+    QColor outlineColor = Qt::yellow;
+    outlineColor.setAlphaF(egg.alpha);
+
+    const RenderAssets *assets = renderAssets.get();
+    if (assets && egg.state == EggState::Falling && egg.scale == 1.0f && egg.alpha >= 1.0f) {
+        // Prebuilt at this size and DPR; same pixel origin the plotter would use
+        QRect r = assets->eggSpriteRect.translated(int(center.x()), int(center.y()));
+        p.drawImage(QRectF(r), assets->eggSprites[int(egg.type)]);
+        return;
+    }
+
+    EggRaster::paintPixelEgg(p, center, w, h, fillColor, outlineColor);
+
+    if (egg.state == EggState::Splat)
+    {
+        int splatW = int(w);
+        int splatH = int(h * 0.4f);
+        QRectF splatRect(center.x() - splatW / 2, center.y() - splatH / 2, splatW, splatH);
+        p.fillRect(splatRect, fillColor);
+        p.setPen(QPen(outlineColor, 2.0));
+        p.drawRect(splatRect);
+    }
+}
+
+// ======================================================
+// GAME DRAWING
+// ======================================================
+
+void GameRenderer::render(QPainter &painter, const GameSimulation &sim, float alpha)
+{
+    // In focus mode, darken the world
+    if (sim.focusMode)
+        painter.fillRect(QRect(0, 0, canvasSide, canvasSide), Qt::black);
+    else
+        painter.drawPixmap(QRect(0, 0, canvasSide, canvasSide), backgroundPix);
+    painter.save();
+    painter.scale(canvasScale, canvasScale);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+
+    float basketRenderX = sim.prevBasketX + (sim.basket.x() - sim.prevBasketX) * alpha;
+    float basketRenderY = sim.basket.y();
+
+    int basketWidthCells = 16;
+    int basketHeightCells = 6;
+
+    QColor basketFill(205, 133, 63);
+    QColor basketOutline(120, 60, 20);
+
+    // -------- FLASH RENDERING --------
+    if (sim.flashColor.isValid() && sim.flashAlpha > 0.0f) {
+        QColor overlay = sim.flashColor;
+        overlay.setAlphaF(sim.flashAlpha * 0.5f);
+        painter.fillRect(canvasRect(), overlay);
+    }
+
+    // ======================================================
+    //               DRAW WIND DUST PARTICLES
+    // ======================================================
+    const quint32 now = sim.stepCount;
+    const float dt = sim.fixedDelta;
+    if (sim.windActive && sim.windParticles.used() > 0) {
+        sim.windParticles.forEach([&](const WindParticle &wp) {
+            if (!wp.aliveAt(now, dt))
+                return;
+
+            QColor dust(230, 230, 230);
+            dust.setAlphaF(0.2f + wp.alphaAt(now, dt) * 0.8f);
+
+            QPointF pos = wp.posAt(now, dt);
+            float px = pos.x() * grid_box;
+            float py = pos.y() * grid_box;
+
+            float size = grid_box * 0.30f;
+
+            painter.setBrush(dust);
+            painter.setPen(Qt::NoPen);
+            painter.drawEllipse(QRectF(px, py, size, size));
+        });
+    }
+
+    // ======================================================
+    //               DRAW WIND STREAK ARROWS >>>> <<<<<
+    // ======================================================
+    if (sim.windActive && sim.windStreaks.used() > 0) {
+
+        // Font size scales with grid
+        painter.setFont(windFont);
+
+        bool right = (sim.windStrength > 0);
+        const QStaticText &arrow = right ? windArrowRight : windArrowLeft;
+
+        sim.windStreaks.forEach([&](const WindStreak &ws) {
+            if (!ws.aliveAt(now, dt))
+                return;
+
+            float px = ws.pos.x() * grid_box;
+            float py = ws.pos.y() * grid_box;
+
+            painter.save();
+
+            // Tilt arrows for style
+            painter.translate(px, py);
+            painter.rotate(right ? 20 : -20);
+
+            QColor col(230, 230, 230);
+            col.setAlphaF(ws.alphaAt(now, dt) * 0.8f);
+
+            painter.setPen(col);
+            painter.drawStaticText(QPointF(0, -windAscent), arrow);
+
+            painter.restore();
+        });
+    }
+
+    // ======================================================
+    //                       DRAW BASKET
+    // ======================================================
+    painter.setBrush(basketFill);
+    painter.setPen(Qt::NoPen);
+
+    for (int y = 0; y < basketHeightCells; ++y) {
+        float rowY = basketRenderY + y;
+        int taper = std::min(y / 1, basketWidthCells / 6);
+        int startX = -basketWidthCells / 2 + taper;
+        int endX = basketWidthCells / 2 - taper;
+        for (int x = startX; x <= endX; ++x) {
+            float cx = basketRenderX + x;
+            float px = cx * grid_box;
+            float py = rowY * grid_box;
+            painter.fillRect(px, py, grid_box, grid_box, basketFill);
+        }
+    }
+
+    painter.setBrush(Qt::NoBrush);
+    QPen rimPen(basketOutline);
+    rimPen.setWidthF(4.0);
+    rimPen.setCapStyle(Qt::RoundCap);
+    rimPen.setJoinStyle(Qt::RoundJoin);
+    painter.setPen(rimPen);
+
+    painter.save();
+    painter.translate(basketRenderX * grid_box, basketRenderY * grid_box);
+    painter.drawPath(rimPath);
+    painter.restore();
+
+    // Basket trail
+    int trailLength = 6;
+    for (int i = 1; i <= trailLength; ++i) {
+        int fade = qMax(10, 120 - i * 18);
+        QColor trailColor(160, 82, 45, fade);
+        float trailX = basketRenderX - sim.basketXVelocity * (i * 0.02f);
+        painter.fillRect((trailX - basketWidthCells / 2.0f) * grid_box,
+                         basketRenderY * grid_box,
+                         basketWidthCells * grid_box,
+                         basketHeightCells * grid_box,
+                         trailColor);
+    }
+
+    // ======================================================
+    //                       DRAW EGGS
+    // ======================================================
+    for (const auto &egg : sim.eggs) {
+        float renderY = egg.prevY + (egg.pos.y() - egg.prevY) * alpha;
+        drawEggShape(painter, egg, renderY, (float)grid_box);
+    }
+
+    // ======================================================
+    //                           HUD
+    // ======================================================
+    updateHudCache(sim);
+
+    painter.setFont(scoreFont);
+    QColor scoreColor(255, 215, 0);
+    if (sim.focusMode) scoreColor = QColor(0, 255, 255);
+
+    // Score pop is just a transform on the cached layout
+    painter.setPen(scoreColor);
+    painter.save();
+    painter.translate(QPointF(30, 45));
+    painter.scale(sim.scoreScale, sim.scoreScale);
+    painter.drawStaticText(QPointF(0, -scoreAscent), scoreText);
+    painter.restore();
+
+    // High score
+    painter.setFont(highScoreFont);
+    painter.setPen(QColor(200, 200, 255));
+    painter.drawStaticText(QPointF(30, 75 - highScoreAscent), highScoreText);
+
+    // Focus Mode banner
+    if (sim.focusMode) {
+        painter.setFont(bannerFont);
+        painter.setPen(QColor(0, 255, 255));
+        QSizeF bannerSize = focusBanner.size();
+        painter.drawStaticText(QPointF((grid_size - bannerSize.width()) / 2.0, 0),
+                               focusBanner);
+    }
+
+    // Lives (hearts)
+    int heartSize = 24;
+    float pulseScale = 1.0f + 0.5f * (sim.livesPulseTimer / 0.3f);
+    for (const QPointF &origin : heartOrigins) {
+        double x = origin.x();
+        double y = origin.y();
+
+        painter.save();
+        painter.translate(x + heartSize / 2.0, y + heartSize / 2.0);
+        painter.scale(pulseScale, pulseScale);
+        painter.translate(-heartSize / 2.0, -heartSize / 2.0);
+        painter.setBrush(Qt::red);
+        painter.setPen(Qt::NoPen);
+        painter.drawPath(heartPath);
+        painter.restore();
+    }
+
+    // --------------------------------------------------------
+    //               EGG SPLAT PARTICLES (existing)
+    // --------------------------------------------------------
+    painter.setPen(Qt::NoPen);
+    const int size = grid_box / 3;
+    sim.particles.forEach([&](const Particle &p) {
+        if (!p.aliveAt(now))
+            return;
+        QColor c = particlePalette[p.palette];
+        c.setAlpha(p.alphaAt(now));
+        painter.setBrush(c);
+        QPoint pos = p.posAt(now);
+        painter.drawEllipse(QPointF(pos.x() / 1000.0, pos.y() / 1000.0) * grid_box,
+                            size, size);
+    });
+
+    painter.restore();
+}
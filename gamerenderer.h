@@ -0,0 +1,77 @@
+#ifndef GAMERENDERER_H
+#define GAMERENDERER_H
+
+#include <QFont>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPixmap>
+#include <QStaticText>
+#include <QVector>
+#include <limits>
+#include <memory>
+
+#include "assetcache.h"
+#include "gamesim.h"
+
+// ======================================================
+// Draws a GameSimulation frame. Holds everything that only
+// changes with the canvas size (fonts, paths, laid-out text,
+// the HUD cache), so a frame is just painting. Works on any
+// paint device: the window's pixmaps or an offscreen QImage.
+// ======================================================
+class GameRenderer
+{
+public:
+    GameRenderer(int gridSize, int gridBox);
+
+    // Target side in device-independent pixels and its pixel ratio
+    void setCanvas(int side, qreal dpr);
+    void setAssets(std::shared_ptr<const RenderAssets> assets);
+
+    int side() const { return canvasSide; }
+    qreal dpr() const { return canvasDpr; }
+    qreal scale() const { return canvasScale; }
+    const QPixmap &background() const { return backgroundPix; }
+
+    // One frame into a side x side device area; alpha interpolates
+    // between the last two steps
+    void render(QPainter &painter, const GameSimulation &sim, float alpha);
+
+private:
+    void drawEggShape(QPainter &p, const Egg &egg, float renderY, float cellSize);
+    void updateHudCache(const GameSimulation &sim);
+    QRect canvasRect() const { return QRect(0, 0, grid_size, grid_size); }
+
+    int grid_size;
+    int grid_box;
+    int canvasSide = 0;
+    qreal canvasDpr = 1.0;
+    qreal canvasScale = 1.0;     // canvasSide / grid_size
+
+    std::shared_ptr<const RenderAssets> renderAssets;
+    QPixmap backgroundPix;
+
+    QFont scoreFont;
+    QFont highScoreFont;
+    QFont bannerFont;
+    QFont windFont;
+    float windAscent = 0.0f;
+    QPainterPath heartPath;      // unit heart at the origin
+    QPainterPath rimPath;        // basket rim relative to basket origin
+    QStaticText windArrowRight;
+    QStaticText windArrowLeft;
+    QStaticText focusBanner;
+    QColor particlePalette[int(EggType::Count)];   // by Particle::palette
+
+    // ---- HUD cache (re-laid-out only when the values change) ----
+    QStaticText scoreText;
+    QStaticText highScoreText;
+    float scoreAscent = 0.0f;
+    float highScoreAscent = 0.0f;
+    int hudScore = std::numeric_limits<int>::min();
+    int hudHighScore = std::numeric_limits<int>::min();
+    int hudLives = -1;
+    QVector<QPointF> heartOrigins;
+};
+
+#endif // GAMERENDERER_H
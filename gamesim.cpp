@@ -0,0 +1,500 @@
+#include "gamesim.h"
+#include "trajectory.h"
+
+#include <QRectF>
+#include <QtMath>
+#include <algorithm>
+
+GameSimulation::GameSimulation(int cols, int rows)
+    : cols(cols),
+    rows(rows)
+{
+    int mid = cols / 2;
+    dropColumns = {mid - 25, mid - 5, mid + 5, mid + 25};
+    std::sort(dropColumns.begin(), dropColumns.end());
+
+    basket = QPointF(cols / 2.0f, rows - 3.0f);
+    prevBasketX = basket.x();
+}
+
+void GameSimulation::reset(quint32 seed)
+{
+    const int keepHighScore = highScore;
+    const QVector<int> keepColumns = dropColumns;
+    const int keepCols = cols;
+    const int keepRows = rows;
+    const int keepBudget = particles.budget();
+
+    // Everything else goes back to its initializer
+    auto sink = std::move(onEvent);
+    BasketController *keepController = controller;
+    *this = GameSimulation(keepCols, keepRows);
+    onEvent = std::move(sink);
+    controller = keepController;
+
+    dropColumns = keepColumns;
+    highScore = keepHighScore;
+    if (particles.budget() != keepBudget)
+        particles.setBudget(keepBudget);
+    rng.seed(seed);
+}
+
+void GameSimulation::integrateBasket(float h)
+{
+    if (h <= 0.0f)
+        return;
+
+    // Same response as one full-step blend of dt * basketAccel, but
+    // split pieces compose exactly, so where an edge lands does not
+    // change how the basket accelerates.
+    float keep = 1.0f - qMin(1.0f, fixedDelta * basketAccel);
+    glideBasket(h, 1.0f - std::pow(keep, h / fixedDelta));
+}
+
+void GameSimulation::glideBasket(float h, float blend)
+{
+    basketTargetVel = steer.targetVelocity(basket.x(), basketMaxVel);
+    basketXVelocity += (basketTargetVel - basketXVelocity) * blend;
+
+    basket.setX(basket.x() + basketXVelocity * h);
+    basket.setX(std::clamp((float)basket.x(), 0.0f, float(cols - 1)));
+}
+
+// ======================================================
+// FIXED STEP
+// ======================================================
+
+void GameSimulation::step(float dt)
+{
+    if (isOver())
+        return;
+
+    ++stepCount;
+    globalTime += dt;
+    globalSpawnTimer += dt;
+
+    // ---------- HUD ANIMATION DECAY ----------
+    advanceHud(dt);
+
+    // ---------- FOCUS MODE STATE (cyclic based on score) ----------
+    bool newFocus = focusFor(score);
+    if (newFocus != focusMode)
+        report(newFocus ? GameEventKind::FocusEnter : GameEventKind::FocusExit);
+    focusMode = newFocus;
+
+    // ---------- WIND STATE UPDATE ----------
+    timeSinceLastWind += dt;
+
+    if (!windActive && timeSinceLastWind >= windCooldown) {
+        if (rng.bounded(1000) < 2) {
+            windActive = true;
+            windTimer = rng.bounded(1200, 2500) / 1000.0f;
+            timeSinceLastWind = 0.0f;
+
+            float minStrength = focusMode ? ModeTraits<true>::windMin : ModeTraits<false>::windMin;
+            float maxStrength = focusMode ? ModeTraits<true>::windMax : ModeTraits<false>::windMax;
+
+            float magnitude = rng.bounded((int)(minStrength * 100),
+                                          (int)(maxStrength * 100)) / 100.0f;
+            int direction = (rng.bounded(0, 2) == 0) ? -1 : 1;
+            windStrength = direction * magnitude;
+            report(GameEventKind::WindStart, EggType::Normal, windStrength);
+        }
+    }
+
+    if (windActive) {
+        windTimer -= dt;
+        if (windTimer <= 0.0f) {
+            windActive = false;
+            windStrength = 0.0f;
+            report(GameEventKind::WindEnd);
+        }
+    }
+
+    if (windActive && std::abs(windStrength) > 0.05f)
+        spawnWindEffects();
+
+    const quint32 now = stepCount;
+    windParticles.retire([now, dt](const WindParticle &wp) { return wp.aliveAt(now, dt); });
+    windStreaks.retire([now, dt](const WindStreak &ws) { return ws.aliveAt(now, dt); });
+
+    // -------------------- EGG SPAWN --------------------
+    if (globalSpawnTimer >= spawnInterval) {
+        int col = dropColumns[currentColumnIndex];
+        bool isEdgeCol = (col == dropColumns.front() || col == dropColumns.back());
+        bool canSpawn = true;
+
+        float dynamicEdgeCooldown = qMax(0.6f, edgeSpawnCooldown - 0.03f * score);
+        if (isEdgeCol && (globalTime - lastEdgeSpawnTime < dynamicEdgeCooldown))
+            canSpawn = false;
+
+        if (canSpawn) {
+            Egg e;
+            e.pos = QPointF(float(col), 0.0f);
+            e.yVelocity = 0.0f;
+            e.state = EggState::Falling;
+
+            int r = rng.bounded(100);
+            for (int t = 0; t < int(EggType::Count); ++t) {
+                r -= kEggTraits[t].spawnWeight;
+                if (r < 0) {
+                    e.type = EggType(t);
+                    break;
+                }
+            }
+
+            eggs.append(e);
+            if (isEdgeCol)
+                lastEdgeSpawnTime = globalTime;
+        }
+
+        currentColumnIndex = (currentColumnIndex + 1) % dropColumns.size();
+        globalSpawnTimer = 0.0f;
+        spawnInterval = 0.8f + rng.bounded(0.6);
+    }
+
+    // -------------------- BASKET MOVEMENT --------------------
+    if (controller)
+        controller->moveBasket(*this, dt);
+    else
+        integrateBasket(dt);
+    prevBasketX = basket.x();
+
+    // -------------------- EGG PHYSICS & DIFFICULTY --------------------
+    EggStepResult stepResult = focusMode ? updateEggs<true>(dt) : updateEggs<false>(dt);
+
+    if (stepResult.caughtAny) score++;
+    if (score > highScore) highScore = score;
+
+    advanceFlash(dt);
+
+    if (stepResult.caughtAny && !isOver()) {
+        scoreAnimTimer = 0.2f;
+        scoreScale = 1.5f;
+    }
+
+    if ((stepResult.lostLifeAny || stepResult.gainedLifeAny) && !isOver())
+        livesPulseTimer = 0.3f;
+
+    particles.retire([now](const Particle &p) { return p.aliveAt(now); });
+}
+
+// The score's pop, easing out over its 0.2 s
+static inline float scoreScaleAt(float scoreAnimTimer)
+{
+    float t = 1.0f - scoreAnimTimer / 0.2f;
+    return 1.0f + 0.5f * (1.0f - t * t); // ease-out
+}
+
+void GameSimulation::advanceHud(float dt)
+{
+    if (scoreAnimTimer > 0.0f) {
+        scoreAnimTimer -= dt;
+        scoreScale = scoreScaleAt(scoreAnimTimer);
+    } else {
+        scoreScale = 1.0f;
+    }
+    if (livesPulseTimer > 0.0f)
+        livesPulseTimer = qMax(0.0f, livesPulseTimer - dt);
+}
+
+void GameSimulation::advanceFlash(float dt)
+{
+    if (flashColor.isValid())
+        showFlash(flashTimer + dt);
+}
+
+void GameSimulation::showFlash(float timer)
+{
+    flashTimer = timer;
+    if (flashTimer < kFlashIn)
+        flashAlpha = flashTimer / kFlashIn;
+    else if (flashTimer < kFlashIn + kFlashOut)
+        flashAlpha = 1.0f - (flashTimer - kFlashIn) / kFlashOut;
+    else {
+        flashColor = QColor();
+        flashAlpha = 0.0f;
+    }
+}
+
+void GameSimulation::spawnWindEffects()
+{
+    // -----------------------------------------------------------
+    //              WIND DUST PARTICLE SPAWNING
+    // -----------------------------------------------------------
+    int count = 8;  // good balance, you can increase to 12 if needed
+
+    SimRandom fx = effectsRandom(stepCount, kDustSalt);
+
+    for (int i = 0; i < count; i++) {
+        WindParticle &wp = windParticles.spawn();
+
+        wp.origin = QPointF(fx.bounded(cols), fx.bounded(int(rows * 0.7f)));
+
+        float dir = (windStrength > 0.0f) ? 1.0f : -1.0f;
+
+        wp.vel = QPointF(dir * (0.4f + fx.bounded(120) / 100.0f),
+                         (fx.bounded(-20, 21) / 100.0f));
+
+        wp.maxLife = 0.6f + (fx.bounded(40) / 100.0f);
+        wp.born = stepCount;
+    }
+
+    // -----------------------------------------------------------
+    //              WIND STREAK SPAWNING (>>>> / <<<<)
+    // -----------------------------------------------------------
+    // Random chance per physics tick to avoid too many streaks
+    if (fx.bounded(100) < 30) {
+        WindStreak &ws = windStreaks.spawn();
+
+        ws.pos = QPointF(fx.bounded(cols), fx.bounded(rows));
+        ws.maxLife = 0.8f;
+        ws.born = stepCount;
+    }
+}
+
+// ======================================================
+// EGG UPDATE (specialised per mode, driven by kEggTraits)
+// ======================================================
+
+template <typename Mode>
+static inline float spawnPace(int score)
+{
+    return qMax(Mode::minSpawn, qMax(0.6f, 1.0f - score * 0.01f) - Mode::spawnBonus);
+}
+
+float GameSimulation::spawnIntervalFor(int score, bool focus)
+{
+    return focus ? spawnPace<ModeTraits<true>>(score) : spawnPace<ModeTraits<false>>(score);
+}
+
+// One step of a falling egg and of a caught one
+static inline void fall(Egg &egg, float accel, float maxFallSpeed, float dt, float windStep, float maxX)
+{
+    egg.yVelocity += accel;
+    egg.yVelocity = qMin(egg.yVelocity, maxFallSpeed);
+    egg.pos.setY(egg.pos.y() + egg.yVelocity * dt);
+    egg.pos.setX(std::clamp(float(egg.pos.x() + windStep), 0.0f, maxX));
+}
+
+static inline void fadeAt(Egg &egg, float animTimer)
+{
+    egg.animTimer = animTimer;
+    egg.scale = 1.0f - egg.animTimer * 3.0f;
+    egg.alpha = 1.0f - egg.animTimer * 2.0f;
+}
+
+static inline void fade(Egg &egg, float dt)
+{
+    fadeAt(egg, egg.animTimer + dt);
+}
+
+template <bool Focus>
+EggStepResult GameSimulation::updateEggs(float dt)
+{
+    using Mode = ModeTraits<Focus>;
+
+    float baseGravity = (10.0f + score * 0.05f) * Mode::gravityScale;
+    float maxFallSpeed = 22.0f * Mode::fallSpeedScale;
+    spawnInterval = spawnPace<Mode>(score);
+
+    const int basketWidth = 16;
+    const int basketHeight = 6;
+    const QRectF basketRect(
+        basket.x() - basketWidth / 2.0f,
+        basket.y() - 0.5f,
+        basketWidth,
+        basketHeight + 1.5f
+        );
+    const float windStep = windActive ? windStrength * dt : 0.0f;
+
+    QVector<Egg> survivors;
+    EggStepResult result;
+    SimRandom splatFx = effectsRandom(stepCount, kSplatSalt);
+
+    auto applyLives = [&](int delta, EggType type) {
+        if (delta == 0)
+            return;
+        int oldLives = lives;
+        lives = std::clamp(lives + delta, 0, kMaxLives);
+        result.lostLifeAny |= delta < 0;
+        result.gainedLifeAny |= lives > oldLives;
+        // At the cap a life egg gains nothing, and is not logged as a gain
+        if (lives != oldLives)
+            report(lives < oldLives ? GameEventKind::LifeLost : GameEventKind::LifeGained, type, lives);
+    };
+
+    for (auto &egg : eggs) {
+        const EggTraits &traits = eggTraits(egg.type);
+        egg.prevY = egg.pos.y();
+
+        if (egg.state == EggState::Falling) {
+            fall(egg, baseGravity * traits.gravityScale * dt, maxFallSpeed, dt, windStep, float(cols - 1));
+
+            QRectF eggRect(egg.pos.x(), egg.pos.y(), 1.0f, 1.0f);
+
+            if (eggRect.intersects(basketRect)) {
+                egg.state = EggState::Caught;
+                egg.animTimer = 0;
+                result.caughtAny = true;
+
+                score += traits.catchScore[Focus];
+                report(GameEventKind::Catch, egg.type, traits.catchScore[Focus], egg.pos.x());
+                applyLives(traits.catchLives, egg.type);
+
+                if (traits.flash) {
+                    flashColor = QColor::fromRgba(traits.flash);
+                    flashAlpha = 0.0f;
+                    flashTimer = 0.0f;
+                }
+            }
+            else if (egg.pos.y() >= rows - 1) {
+                egg.state = EggState::Splat;
+                egg.animTimer = 0;
+                report(GameEventKind::Splat, egg.type, 0.0f, egg.pos.x());
+                applyLives(traits.splatLives, egg.type);
+            }
+
+            survivors.push_back(egg);
+        }
+        else if (egg.state == EggState::Caught) {
+            fade(egg, dt);
+            if (egg.animTimer < 0.5f)
+                survivors.push_back(egg);
+        }
+        else if (egg.state == EggState::Splat && egg.animTimer < 1) {
+            splatBurst(egg, splatFx, stepCount);
+        }
+    }
+
+    eggs = survivors;
+    return result;
+}
+
+void GameSimulation::splatBurst(const Egg &egg, SimRandom &fx, quint32 born)
+{
+    const int numParticles = 12;
+    const int scale = 1000;
+    const QPoint origin(int(egg.pos.x() * scale), int(egg.pos.y() * scale));
+    Particle *burst = particles.spawnBurst(numParticles);
+    for (int i = 0; i < numParticles; ++i) {
+        int angleDeg = fx.bounded(360);
+        double rad = angleDeg * M_PI / 180.0;
+
+        int speed = fx.bounded(500, 1500);
+
+        Particle &p = burst[i];
+        p.origin = origin;
+        p.velocity = QPoint(int(cos(rad) * speed), int(sin(rad) * speed));
+        p.born = born;
+        p.life = qint16(fx.bounded(30, 60));
+        p.palette = quint8(egg.type);
+    }
+}
+
+// ======================================================
+// COAST: steps with nothing to decide
+// ======================================================
+
+void GameSimulation::coast(int steps)
+{
+    if (steps <= 0)
+        return;
+    if (focusMode)
+        coastSteps<true>(steps);
+    else
+        coastSteps<false>(steps);
+}
+
+template <bool Focus>
+void GameSimulation::coastSteps(int steps)
+{
+    using Mode = ModeTraits<Focus>;
+    const float dt = fixedDelta;
+
+    // Nothing couples the parts of a quiet step, so each jumps over
+    // all the steps on its own (see trajectory.h)
+
+    // ---------- TIMERS ----------
+    const quint32 first = stepCount + 1;
+    stepCount += quint32(steps);
+    quint64 rolls = 0;      // past the cooldown each step rolls, and fails
+    if (!windActive) {
+        const int rollsFrom = Trajectory::stepsUntil(timeSinceLastWind, dt, windCooldown, steps + 1);
+        rolls = quint64(steps - rollsFrom + 1);
+    }
+    rng.discard(rolls);
+    globalTime = Trajectory::timerAfter(globalTime, dt, steps);
+    globalSpawnTimer = Trajectory::timerAfter(globalSpawnTimer, dt, steps);
+    timeSinceLastWind = Trajectory::timerAfter(timeSinceLastWind, dt, steps);
+    if (windActive)
+        windTimer = Trajectory::timerAfter(windTimer, -dt, steps);
+
+    // ---------- HUD AND FLASH: the last step each runs, then rest ----------
+    if (scoreAnimTimer > 0.0f) {
+        const int runs = Trajectory::stepsUntil(scoreAnimTimer, -dt, 0.0f, steps + 1);
+        scoreAnimTimer = Trajectory::timerAfter(scoreAnimTimer, -dt, qMin(runs, steps));
+        scoreScale = runs < steps ? 1.0f : scoreScaleAt(scoreAnimTimer);
+    } else {
+        scoreScale = 1.0f;
+    }
+    if (livesPulseTimer > 0.0f)
+        livesPulseTimer = qMax(0.0f, Trajectory::timerAfter(livesPulseTimer, -dt, steps));
+    if (flashColor.isValid()) {
+        const int runs = Trajectory::stepsUntil(flashTimer, dt, kFlashIn + kFlashOut, steps);
+        showFlash(Trajectory::timerAfter(flashTimer, dt, runs));
+    }
+
+    // ---------- BASKET: jumped where glide() can, stepped where not ----------
+    const float keep = 1.0f - qMin(1.0f, fixedDelta * basketAccel);
+    const float blend = 1.0f - std::pow(keep, dt / fixedDelta);
+    for (int left = steps; left > 0;) {
+        const BasketGlide glided = Trajectory::glide(*this, left);
+        if (glided.steps == 0) {
+            glideBasket(dt, blend);
+            --left;
+            continue;
+        }
+        basket.setX(glided.x);
+        basketXVelocity = glided.velocity;
+        basketTargetVel = steer.targetVelocity(glided.x, basketMaxVel);
+        left -= glided.steps;
+    }
+    prevBasketX = basket.x();
+
+    // ---------- EGGS ----------
+    const float maxFallSpeed = 22.0f * Mode::fallSpeedScale;
+    const float maxX = float(cols - 1);
+    const float windStep = windActive ? windStrength * dt : 0.0f;
+    spawnInterval = spawnPace<Mode>(score);
+    SimRandom splatFx = effectsRandom(first, kSplatSalt);
+    auto gone = [&](Egg &egg) {
+        if (egg.state == EggState::Falling) {
+            // The speed and the drift are timers too; the height is
+            // summed in closed form up to the last step, which is taken
+            // as updateEggs takes it
+            const FallModel m = Trajectory::model(*this, egg.type);
+            const double before = Trajectory::yAfter(m, egg.pos.y(), egg.yVelocity, steps - 1);
+            egg.yVelocity = qMin(Trajectory::timerAfter(egg.yVelocity, float(m.accel), steps), maxFallSpeed);
+            egg.prevY = before;
+            egg.pos.setY(before + egg.yVelocity * dt);
+            if (windStep != 0.0f)
+                egg.pos.setX(std::clamp(Trajectory::timerAfter(float(egg.pos.x()), windStep, steps), 0.0f, maxX));
+            return false;
+        }
+        if (egg.state == EggState::Splat) {
+            splatBurst(egg, splatFx, first);    // the first step bursts it
+            return true;
+        }
+        egg.prevY = egg.pos.y();
+        fadeAt(egg, Trajectory::timerAfter(egg.animTimer, dt, steps));
+        return egg.animTimer >= 0.5f;
+    };
+    eggs.erase(std::remove_if(eggs.begin(), eggs.end(), gone), eggs.end());
+
+    // Retiring late retires the same particles: none came in between
+    const quint32 now = stepCount;
+    windParticles.retire([now, dt](const WindParticle &wp) { return wp.aliveAt(now, dt); });
+    windStreaks.retire([now, dt](const WindStreak &ws) { return ws.aliveAt(now, dt); });
+    particles.retire([now](const Particle &p) { return p.aliveAt(now); });
+}
@@ -0,0 +1,234 @@
+#ifndef GAMESIM_H
+#define GAMESIM_H
+
+#include <QColor>
+#include <QPointF>
+#include <QVector>
+#include <functional>
+
+#include "analytics.h"
+#include "eggtraits.h"
+#include "inputqueue.h"
+#include "particlepool.h"
+
+struct Egg {
+    QPointF pos;
+    float prevY;
+    float yVelocity;
+    EggState state = EggState::Falling;
+    float animTimer = 0;
+    float scale = 1.0f;
+    float alpha = 1.0f;
+    EggType type = EggType::Normal;  // see kEggTraits for per-type behaviour
+};
+
+struct EggStepResult {
+    bool caughtAny = false;
+    bool lostLifeAny = false;
+    bool gainedLifeAny = false;
+};
+
+// ======================================================
+// The simulation's random numbers: PCG32, so the whole
+// generator is one 64-bit word a snapshot can carry and the
+// sequence is the same on every platform and Qt version.
+// Same bounded() calls as QRandomGenerator.
+// ======================================================
+class SimRandom
+{
+public:
+    void seed(quint64 s)
+    {
+        state = 0;
+        generate();
+        state += s;
+        generate();
+    }
+
+    quint32 generate()
+    {
+        quint64 old = state;
+        state = old * 6364136223846793005ULL + 1442695040888963407ULL;
+        quint32 xorShifted = quint32(((old >> 18) ^ old) >> 27);
+        quint32 rot = quint32(old >> 59);
+        return (xorShifted >> rot) | (xorShifted << ((32 - rot) & 31));
+    }
+
+    // [0, highest)
+    int bounded(int highest) { return int((quint64(generate()) * quint32(highest)) >> 32); }
+    // [lowest, highest)
+    int bounded(int lowest, int highest) { return lowest + bounded(highest - lowest); }
+    double bounded(double highest) { return generate() * (1.0 / 4294967296.0) * highest; }
+
+    // n calls to generate() as one multiply-add on the state
+    struct Jump {
+        quint64 mult = 1;
+        quint64 inc = 0;
+    };
+    static Jump jump(quint64 n)
+    {
+        quint64 mult = 6364136223846793005ULL;
+        quint64 inc = 1442695040888963407ULL;
+        Jump j;
+        for (; n; n >>= 1) {
+            if (n & 1) {
+                j.mult *= mult;
+                j.inc = j.inc * mult + inc;
+            }
+            inc = (mult + 1) * inc;
+            mult *= mult;
+        }
+        return j;
+    }
+    void discard(const Jump &j) { state = j.mult * state + j.inc; }
+    void discard(quint64 n) { discard(jump(n)); }
+
+    quint64 state = 0x853c49e6748fea9bULL;
+};
+
+class GameSimulation;
+
+// ======================================================
+// Whatever steers the basket: the player's input, a bot.
+// Called once per fixed step before the eggs move; it sets
+// sim.steer and integrates the basket over dt (integrateBasket),
+// in one go or in pieces.
+//
+// holdSteps() is asked between steps: for how many of the coming
+// steps moveBasket would do nothing but integrate under the steer
+// it has set, as long as nothing happens on the field. FastForward
+// coasts through those; 0 has it asked every step.
+// ======================================================
+class BasketController
+{
+public:
+    virtual ~BasketController() = default;
+    virtual void moveBasket(GameSimulation &sim, float dt) = 0;
+    virtual int holdSteps(const GameSimulation &) const { return 0; }
+};
+
+// ======================================================
+// The game itself: everything a fixed step changes, with no
+// widgets, painting or I/O. MainWindow drives it from the frame
+// loop; tools drive it headless from a fixed seed, and the same
+// seed and inputs always give the same game.
+// ======================================================
+class GameSimulation
+{
+public:
+    // Reported after the change it describes. x is the egg's column
+    // for egg events; value is as logged by SessionLogger.
+    using EventSink = std::function<void(GameEventKind kind, EggType type, float value, float x)>;
+
+    GameSimulation(int cols, int rows);
+
+    // New game: clears the field, reseeds, keeps highScore
+    void reset(quint32 seed);
+    void step(float dt);
+    void integrateBasket(float h);
+    // Fixed steps known to hold no spawn, gust change, catch or
+    // splat (see FastForward), jumped in one go: the timers land on
+    // the floats step() would give, the eggs and the basket within
+    // rounding of them (Trajectory). Caught eggs fade out and splats
+    // burst as they would; no wind dust or streaks are made. The
+    // basket glides under `steer`, the controller is not asked.
+    void coast(int steps);
+    bool isOver() const { return lives <= 0; }
+    // Focus mode cycles with the score: 100 points on, 50 off from 50
+    static bool focusFor(int score) { return score >= 50 && (score - 50) % 150 < 100; }
+    // The spawn pace updateEggs sets at a score
+    static float spawnIntervalFor(int score, bool focus);
+
+    // Not owned; unset, `steer` is integrated as held
+    BasketController *controller = nullptr;
+    EventSink onEvent;
+
+    // ---- Field ----
+    int cols;
+    int rows;
+    QVector<int> dropColumns;
+    SimRandom rng;
+
+    // Particles are aged against stepCount, see particlepool.h
+    static constexpr int kSplatBudget = 1024;
+    static constexpr int kDustBudget = 1024;     // 8 a step for up to 1 s
+    static constexpr int kStreakBudget = 64;
+    QVector<Egg> eggs;
+    ParticleRing<Particle> particles{kSplatBudget};
+    ParticleRing<WindParticle> windParticles{kDustBudget};
+    ParticleRing<WindStreak> windStreaks{kStreakBudget};
+
+    // ---- Basket ----
+    QPointF basket;
+    float prevBasketX = 0.0f;
+    float basketXVelocity = 0.0f;
+    float basketTargetVel = 0.0f;
+    float basketAccel = 25.0f;
+    float basketMaxVel = 50.0f;
+    float fixedDelta = 1.0f / 120.0f;
+    SteerState steer;
+
+    // ---- Timers / spawning ----
+    quint32 stepCount = 0;
+    float globalTime = 0.0f;
+    float globalSpawnTimer = 0.0f;
+    float spawnInterval = 1.0f;
+    float lastEdgeSpawnTime = -100.0f;
+    float edgeSpawnCooldown = 4.0f;
+    int currentColumnIndex = 0;
+
+    // ---- Score ----
+    int score = 0;
+    int lives = 3;
+    int highScore = 0;
+
+    // ---- Effects (advance with the steps so replays match) ----
+    float flashAlpha = 0.0f;
+    QColor flashColor;
+    float flashTimer = 0.0f;
+    float scoreScale = 1.0f;
+    float scoreAnimTimer = 0.0f;
+    float livesPulseTimer = 0.0f;
+
+    // ---- Wind system ----
+    bool windActive = false;
+    float windStrength = 0.0f;      // grid cells per second, +/- for left/right
+    float windTimer = 0.0f;         // remaining time for current wind event
+    float windCooldown = 8.0f;      // minimum time between wind events
+    float timeSinceLastWind = 0.0f; // time since last wind ended
+
+    // ---- Focus mode ----
+    bool focusMode = false;         // true when in focus mode (score-based cycles)
+
+private:
+    template <bool Focus> EggStepResult updateEggs(float dt);
+    template <bool Focus> void coastSteps(int steps);
+    void glideBasket(float h, float blend);
+    static constexpr float kFlashIn = 0.2f;
+    static constexpr float kFlashOut = 0.5f;
+    static constexpr quint32 kDustSalt = 1;
+    static constexpr quint32 kSplatSalt = 2;
+
+    // For looks only (wind dust, splat bursts): drawn from the step
+    // number, not from rng, so the game's own draws never depend on
+    // them and coast() can skip or make them without touching rng
+    static SimRandom effectsRandom(quint32 step, quint32 salt)
+    {
+        SimRandom fx;
+        fx.seed((quint64(salt) << 32) | step);
+        return fx;
+    }
+
+    void advanceHud(float dt);
+    void advanceFlash(float dt);
+    void showFlash(float timer);
+    void spawnWindEffects();
+    void splatBurst(const Egg &egg, SimRandom &fx, quint32 born);
+    void report(GameEventKind kind, EggType type = EggType::Normal, float value = 0.0f, float x = 0.0f)
+    {
+        if (onEvent)
+            onEvent(kind, type, value, x);
+    }
+};
+
+#endif // GAMESIM_H
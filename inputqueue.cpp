@@ -0,0 +1,181 @@
+#include "inputqueue.h"
+
+#include <QSocketNotifier>
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <linux/joystick.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#define NOMINMAX
+#include <windows.h>
+#include <xinput.h>
+#endif
+
+/* -------------------------------------------------------------
+   QUEUE
+--------------------------------------------------------------*/
+void InputQueue::push(const InputEvent &event)
+{
+    if (count == kCapacity) {
+        // Full: the oldest edge is older than any step still to run
+        head = (head + 1) % kCapacity;
+        --count;
+    }
+    ring[(head + count) % kCapacity] = event;
+    ++count;
+}
+
+bool InputQueue::takeUntil(qint64 timeNs, InputEvent &out)
+{
+    if (count == 0 || ring[head].timeNs > timeNs)
+        return false;
+
+    out = ring[head];
+    head = (head + 1) % kCapacity;
+    --count;
+    return true;
+}
+
+/* -------------------------------------------------------------
+   STEERING
+--------------------------------------------------------------*/
+void SteerState::apply(const InputEvent &event)
+{
+    quint8 bit = quint8(1u << int(event.source));
+    quint8 &mask = held[int(event.action)];
+    if (event.pressed) {
+        mask |= bit;
+        pointerActive = false;
+    } else {
+        mask &= quint8(~bit);
+    }
+}
+
+float SteerState::targetVelocity(float basketX, float maxVel) const
+{
+    bool left = held[int(InputAction::Left)] != 0;
+    bool right = held[int(InputAction::Right)] != 0;
+    if (left != right)
+        return left ? -maxVel : maxVel;
+    if (left || !pointerActive)
+        return 0.0f;
+
+    // Proportional: full speed far away, easing in on the pointer
+    return std::clamp((pointerX - basketX) * kPointerGain, -maxVel, maxVel);
+}
+
+/* -------------------------------------------------------------
+   LATENCY
+--------------------------------------------------------------*/
+void InputLatencyStats::add(InputSource source, qint64 ns)
+{
+    QVector<qint64> &s = samples[int(source)];
+    if (s.size() < kMaxSamples)
+        s.append(ns);
+}
+
+void InputLatencyStats::clear()
+{
+    for (QVector<qint64> &s : samples)
+        s.clear();
+}
+
+QString InputLatencyStats::summary() const
+{
+    static const char *names[] = { "keyboard", "mouse", "gamepad" };
+
+    QString text;
+    for (int i = 0; i < int(InputSource::Count); ++i) {
+        QVector<qint64> s = samples[i];
+        if (s.isEmpty())
+            continue;
+
+        std::sort(s.begin(), s.end());
+        qint64 sum = 0;
+        for (qint64 v : s)
+            sum += v;
+        auto us = [](qint64 ns) { return QString::number(ns / 1000.0, 'f', 0); };
+
+        text += QString("%1: n=%2 mean=%3us p50=%4us p99=%5us max=%6us\n")
+                    .arg(names[i])
+                    .arg(s.size())
+                    .arg(us(sum / s.size()), us(s[s.size() / 2]),
+                         us(s[qMin<int>(s.size() - 1, s.size() * 99 / 100)]), us(s.last()));
+    }
+    return text;
+}
+
+/* -------------------------------------------------------------
+   GAMEPAD
+--------------------------------------------------------------*/
+GamepadInput::GamepadInput(InputQueue &queue, const QElapsedTimer &clock, QObject *owner)
+    : queue(queue),
+    clock(clock)
+{
+#if defined(Q_OS_LINUX)
+    fd = ::open("/dev/input/js0", O_RDONLY | O_NONBLOCK);
+    if (fd < 0)
+        return;
+
+    connected = true;
+    notifier = new QSocketNotifier(fd, QSocketNotifier::Read, owner);
+    QObject::connect(notifier, &QSocketNotifier::activated, notifier, [this]() {
+        js_event ev;
+        while (::read(fd, &ev, sizeof(ev)) == sizeof(ev)) {
+            if ((ev.type & ~JS_EVENT_INIT) != JS_EVENT_AXIS)
+                continue;
+            // Axis 0: left stick X, axis 6: d-pad X on most pads
+            if (ev.number == 0 || ev.number == 6)
+                setAxis(ev.value < -16384 ? -1 : ev.value > 16384 ? 1 : 0);
+        }
+    });
+#else
+    Q_UNUSED(owner);
+#endif
+}
+
+GamepadInput::~GamepadInput()
+{
+#if defined(Q_OS_LINUX)
+    delete notifier;
+    if (fd >= 0)
+        ::close(fd);
+#endif
+}
+
+void GamepadInput::poll()
+{
+#if defined(Q_OS_WIN)
+    XINPUT_STATE state;
+    connected = XInputGetState(0, &state) == ERROR_SUCCESS;
+    if (!connected) {
+        setAxis(0);
+        return;
+    }
+
+    const XINPUT_GAMEPAD &pad = state.Gamepad;
+    int direction = 0;
+    if ((pad.wButtons & XINPUT_GAMEPAD_DPAD_LEFT) || pad.sThumbLX < -16384)
+        direction = -1;
+    else if ((pad.wButtons & XINPUT_GAMEPAD_DPAD_RIGHT) || pad.sThumbLX > 16384)
+        direction = 1;
+    setAxis(direction);
+#endif
+}
+
+void GamepadInput::setAxis(int direction)
+{
+    if (direction == lastDirection)
+        return;
+
+    qint64 now = clock.nsecsElapsed();
+    if (lastDirection != 0)
+        queue.push({ now, InputSource::Gamepad,
+                     lastDirection < 0 ? InputAction::Left : InputAction::Right, false });
+    if (direction != 0)
+        queue.push({ now, InputSource::Gamepad,
+                     direction < 0 ? InputAction::Left : InputAction::Right, true });
+    lastDirection = direction;
+}
@@ -0,0 +1,129 @@
+#ifndef INPUTQUEUE_H
+#define INPUTQUEUE_H
+
+#include <QElapsedTimer>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+#include <array>
+
+class QObject;
+class QSocketNotifier;
+
+enum class InputSource : quint8 { Keyboard, Mouse, Gamepad, Count };
+enum class InputAction : quint8 { Left, Right };
+
+struct InputEvent {
+    qint64 timeNs;          // input clock time the event reached the app
+    InputSource source;
+    InputAction action;
+    bool pressed;
+};
+
+// Latest mouse/touch position; every move overwrites it, the
+// physics step reads it once, so the move rate never matters
+struct PointerSample {
+    QPointF pos;            // label coordinates
+    qint64 timeNs = 0;      // input clock time of the newest move
+    quint32 seq = 0;        // bumped on every move, touch or release
+    bool active = false;    // false after a touch ends
+};
+
+// ======================================================
+// Timestamped input edges, consumed by the fixed-step loop
+//
+// Events are stamped when they arrive and queued instead of
+// flipping booleans, so the physics step can apply each one at
+// the moment inside the step it happened and a tap shorter than
+// a step is still seen. Fixed-size ring. Pointer motion does not
+// go through here, see PointerSample.
+// ======================================================
+class InputQueue
+{
+public:
+    static constexpr int kCapacity = 256;
+
+    void push(const InputEvent &event);
+    // Pops the oldest event stamped at or before timeNs
+    bool takeUntil(qint64 timeNs, InputEvent &out);
+    void clear() { head = count = 0; }
+    int size() const { return count; }
+
+private:
+    std::array<InputEvent, kCapacity> ring;
+    int head = 0;
+    int count = 0;
+};
+
+/* -------------------------------------------------------------
+   What the input adds up to: digital sources hold left or right;
+   the pointer is absolute, the basket is driven toward its column
+   until a key or pad takes over again.
+--------------------------------------------------------------*/
+class SteerState
+{
+public:
+    static constexpr float kPointerGain = 12.0f;      // 1/s, cells off -> cells/s
+
+    void apply(const InputEvent &event);
+    void setPointer(float column) { pointerActive = true; pointerX = column; }
+    void releasePointer() { pointerActive = false; }
+    void reset() { *this = SteerState(); }
+
+    // Velocity the basket should blend toward, in cells/s
+    float targetVelocity(float basketX, float maxVel) const;
+
+    // What is held right now, for sending over the network
+    bool holding(InputAction action) const { return held[int(action)] != 0; }
+    bool pointerHeld() const { return pointerActive; }
+    float pointerColumn() const { return pointerX; }
+
+private:
+    quint8 held[2] = { 0, 0 };    // per action, bit per InputSource
+    bool pointerActive = false;
+    float pointerX = 0.0f;
+};
+
+/* -------------------------------------------------------------
+   Event-to-velocity latency, per source
+--------------------------------------------------------------*/
+class InputLatencyStats
+{
+public:
+    static constexpr int kMaxSamples = 4096;
+
+    void add(InputSource source, qint64 ns);
+    void clear();
+    QString summary() const;
+
+private:
+    QVector<qint64> samples[int(InputSource::Count)];
+};
+
+// ======================================================
+// Gamepad: left stick X and d-pad become Left/Right edges.
+// Linux reads /dev/input/js0 as events arrive; Windows polls
+// XInput pad 0 once per tick. Other platforms have no pad.
+// ======================================================
+class GamepadInput
+{
+public:
+    GamepadInput(InputQueue &queue, const QElapsedTimer &clock, QObject *owner);
+    ~GamepadInput();
+
+    bool isConnected() const { return connected; }
+    // Windows only, no-op elsewhere
+    void poll();
+
+private:
+    void setAxis(int direction);   // -1, 0, +1 from stick or d-pad
+
+    InputQueue &queue;
+    const QElapsedTimer &clock;
+    bool connected = false;
+    int lastDirection = 0;
+    int fd = -1;
+    QSocketNotifier *notifier = nullptr;
+};
+
+#endif // INPUTQUEUE_H
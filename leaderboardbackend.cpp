@@ -0,0 +1,664 @@
+#include "leaderboardbackend.h"
+#include "leaderboardparser.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QUrlQuery>
+#include <algorithm>
+#include <cstring>
+
+void LeaderboardBackend::assignRanks(QVector<ScoreEntry> &window, int firstRank)
+{
+    for (int i = 0; i < window.size(); ++i) {
+        window[i].rank = (i > 0 && window[i].score == window[i - 1].score)
+                             ? window[i - 1].rank
+                             : firstRank + i;
+    }
+}
+
+// ======================================================
+// REST (Firebase)
+//
+// One QNetworkAccessManager keeps a pooled keep-alive connection
+// per host (HTTP/2 where the server offers it, so requests are
+// multiplexed on that one connection). Qt adds
+// "Accept-Encoding: gzip, deflate" itself and inflates the body
+// transparently, so the header is deliberately not set by hand.
+// ======================================================
+static const char kNullEtag[] = "null_etag";   // Firebase's ETag for "no data"
+
+struct RestLeaderboardBackend::PendingGet
+{
+    QNetworkReply *reply = nullptr;
+    bool done = false;
+    bool ok = false;
+    QByteArray etag;
+    QByteArray body;                                   // record reads
+    std::unique_ptr<LeaderboardStreamParser> parser;   // queries, until done
+    QVector<ScoreEntry> top;
+};
+
+RestLeaderboardBackend::RestLeaderboardBackend(const QString &baseUrl)
+    : baseUrl(baseUrl)
+{
+}
+
+void RestLeaderboardBackend::warmUp()
+{
+    // Runs after the first menu frame (LeaderboardManager::warmUp), not
+    // at construction: the connection opens while the menu is up,
+    // not on the first submit
+    QUrl url(baseUrl);
+    if (url.scheme() == "https")
+        net.connectToHostEncrypted(url.host(), url.port(443));
+    else if (url.scheme() == "http")
+        net.connectToHost(url.host(), url.port(80));
+}
+
+RestLeaderboardBackend::~RestLeaderboardBackend() = default;
+
+QString RestLeaderboardBackend::recordUrl(const QString &uniqueID) const
+{
+    return QString("%1/%2.json").arg(baseUrl, uniqueID);
+}
+
+QString RestLeaderboardBackend::countsUrl() const
+{
+    return baseUrl + "_counts.json";
+}
+
+QNetworkRequest RestLeaderboardBackend::makeRequest(const QUrl &url) const
+{
+    QNetworkRequest req(url);
+    req.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    req.setRawHeader("X-Firebase-ETag", "true");
+    return req;
+}
+
+/* -------------------------------------------------------------
+   GET: identical requests already on the wire are shared.
+   The backend blocks in a nested event loop, so a second caller
+   (a timer, a button) can ask for the same URL meanwhile; it
+   waits on the first reply instead of sending another one.
+--------------------------------------------------------------*/
+std::shared_ptr<RestLeaderboardBackend::PendingGet>
+RestLeaderboardBackend::startGet(const QUrl &url, int keep)
+{
+    QString key = url.toString() + '#' + QString::number(keep);
+    auto it = pending.constFind(key);
+    if (it != pending.constEnd())
+        return *it;
+
+    auto get = std::make_shared<PendingGet>();
+    if (keep > 0)
+        get->parser = std::make_unique<LeaderboardStreamParser>(keep);
+
+    QNetworkReply *rep = net.get(makeRequest(url));
+    rep->setReadBufferSize(kReadChunk);   // keep Qt from buffering the whole body
+    get->reply = rep;
+    pending.insert(key, get);
+
+    PendingGet *g = get.get();
+    auto drain = [rep, g]() {
+        char buf[kReadChunk];
+        qint64 n;
+        while ((n = rep->read(buf, sizeof(buf))) > 0) {
+            if (g->parser)
+                g->parser->feed(buf, n);
+            else
+                g->body.append(buf, n);
+        }
+    };
+
+    // Connected before any waiter, so the result is ready when they wake
+    QObject::connect(rep, &QNetworkReply::readyRead, rep, drain);
+    QObject::connect(rep, &QNetworkReply::finished, rep, [this, key, get, rep, drain]() {
+        drain();
+        get->ok = rep->error() == QNetworkReply::NoError
+                  && !(get->parser && get->parser->failed());
+        get->etag = rep->rawHeader("ETag");
+        if (get->parser) {
+            get->top = get->parser->takeTop();
+            get->parser.reset();
+        }
+        get->done = true;
+        pending.remove(key);
+        rep->deleteLater();
+    });
+    return get;
+}
+
+void RestLeaderboardBackend::wait(const std::shared_ptr<PendingGet> &get)
+{
+    if (get->done)
+        return;
+
+    QEventLoop loop;
+    QObject::connect(get->reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+void RestLeaderboardBackend::remember(const QString &uniqueID, const QByteArray &etag,
+                                      const QByteArray &body)
+{
+    Known k;
+    k.etag = etag;
+    QJsonObject obj = QJsonDocument::fromJson(body).object();
+    k.exists = obj.contains("score");
+    k.score = obj["score"].toInt(-1);
+    k.name = obj["name"].toString();
+    known.insert(uniqueID, k);
+}
+
+/* -------------------------------------------------------------
+   ADD OR UPDATE PLAYER SCORE
+
+   One conditional PUT (if-match) instead of GET then PUT. The
+   ETag comes from the last read or write of this record, or is
+   "null_etag" for a record we have never seen. On 412 the server
+   returns the current value and ETag, so a retry needs no GET.
+   A write that changes the score moves the record between two
+   buckets of the score histogram (see rankForScore).
+--------------------------------------------------------------*/
+void RestLeaderboardBackend::submit(const QString &uniqueID,
+                                    const QString &name,
+                                    int score)
+{
+    QJsonObject data;
+    data["name"] = name;
+    data["score"] = score;
+    QByteArray payload = QJsonDocument(data).toJson(QJsonDocument::Compact);
+
+    for (int attempt = 0; attempt < kMaxWriteAttempts; ++attempt) {
+        auto it = known.constFind(uniqueID);
+        QByteArray etag = kNullEtag;
+        if (it != known.constEnd()) {
+            if (it->exists && !needsWrite(it->score, it->name, score, name))
+                return;
+            if (!it->etag.isEmpty())
+                etag = it->etag;
+        }
+        // What the write replaces, if the ETag still matches
+        const bool existed = it != known.constEnd() && it->exists;
+        const int oldScore = existed ? it->score : 0;
+
+        QNetworkRequest req = makeRequest(QUrl(recordUrl(uniqueID)));
+        req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+        req.setRawHeader("if-match", etag);
+
+        QNetworkReply *rep = net.put(req, payload);
+
+        QEventLoop loop;
+        QObject::connect(rep, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+        loop.exec();
+
+        int status = rep->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        QNetworkReply::NetworkError error = rep->error();
+        QString errorText = rep->errorString();
+        QByteArray newEtag = rep->rawHeader("ETag");
+        QByteArray body = rep->readAll();
+        rep->deleteLater();
+
+        if (status == 412) {
+            // Someone else wrote first (or our ETag was stale)
+            remember(uniqueID, newEtag, body);
+            continue;
+        }
+
+        if (error != QNetworkReply::NoError) {
+            qDebug() << "LEADERBOARD WRITE FAILED:" << errorText;
+            known.remove(uniqueID);
+            return;
+        }
+
+        remember(uniqueID, newEtag, payload);
+        if (!existed || oldScore != score)
+            moveCount(existed ? oldScore : -1, score);
+        return;
+    }
+}
+
+// Histogram keys are prefixed: bare numbers would make Firebase
+// return the node as a JSON array
+static QString countKey(int score)
+{
+    return QString("s%1").arg(score);
+}
+
+// Written only by rebuildCounts(): increments alone on a table
+// that was never counted give a histogram missing most players
+static const char kSeededKey[] = "_seeded";
+
+void RestLeaderboardBackend::moveCount(int from, int to)
+{
+    QJsonObject change;
+    change[countKey(to)] = QJsonObject{ { ".sv", QJsonObject{ { "increment", 1 } } } };
+    if (from >= 0)
+        change[countKey(from)] = QJsonObject{ { ".sv", QJsonObject{ { "increment", -1 } } } };
+
+    // One multi-path PATCH, applied atomically by the server
+    QNetworkRequest req = makeRequest(QUrl(countsUrl()));
+    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    QNetworkReply *rep = net.sendCustomRequest(req, "PATCH",
+                                               QJsonDocument(change).toJson(QJsonDocument::Compact));
+    QObject::connect(rep, &QNetworkReply::finished, rep, [rep]() {
+        if (rep->error() != QNetworkReply::NoError)
+            qDebug() << "LEADERBOARD COUNT UPDATE FAILED:" << rep->errorString();
+        rep->deleteLater();
+    });
+}
+
+bool RestLeaderboardBackend::fetchRecord(const QString &uniqueID, int &score, QString &name)
+{
+    auto get = startGet(QUrl(recordUrl(uniqueID)), 0);
+    wait(get);
+
+    if (!get->ok)
+        return false;
+
+    remember(uniqueID, get->etag, get->body);
+    const Known &k = known[uniqueID];
+    if (k.exists)
+        score = k.score;
+    name = k.name;
+    return k.exists;
+}
+
+/* -------------------------------------------------------------
+   QUERIES: streamed through LeaderboardStreamParser
+--------------------------------------------------------------*/
+QVector<ScoreEntry> RestLeaderboardBackend::fetchQuery(const QString &params, int keep)
+{
+    QUrl url(baseUrl + ".json");
+    if (!params.isEmpty())
+        url.setQuery(QUrlQuery(params));
+
+    auto get = startGet(url, keep);
+    wait(get);
+
+    if (!get->ok)
+        return {};
+
+    return get->top;
+}
+
+QVector<ScoreEntry> RestLeaderboardBackend::top(int count)
+{
+    QVector<ScoreEntry> result = fetchQuery(QString("orderBy=\"score\"&limitToLast=%1").arg(count), count);
+    assignRanks(result, 1);
+    return result;
+}
+
+/* -------------------------------------------------------------
+   RANK: the queries need ".indexOn": "score" in the database
+   rules (database.rules.json). The rank itself comes from a
+   histogram kept next to the table ("<node>_counts": records
+   per score), so the read grows with the number of distinct
+   scores, not of players. A table that predates the histogram
+   has it seeded once by rebuildCounts() (eggbench recount);
+   submit() keeps it current from then on. Until then, or when
+   it does not even hold the player's own score, the rank is
+   unknown rather than wrong.
+--------------------------------------------------------------*/
+int RestLeaderboardBackend::rankOf(const QString &uniqueID)
+{
+    int score = 0;
+    QString name;
+    if (!fetchRecord(uniqueID, score, name))
+        return 0;
+    return rankForScore(score);
+}
+
+int RestLeaderboardBackend::rankForScore(int score)
+{
+    auto get = startGet(QUrl(countsUrl()), 0);
+    wait(get);
+    if (!get->ok)
+        return 0;
+
+    const QJsonObject counts = QJsonDocument::fromJson(get->body).object();
+    if (!counts.value(kSeededKey).toBool() || counts.value(countKey(score)).toInt() < 1)
+        return 0;
+
+    qint64 better = 0;
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        if (it.key().startsWith('s') && it.key().mid(1).toInt() > score)
+            better += qMax(0, it.value().toInt());
+    }
+    return int(better) + 1;
+}
+
+bool RestLeaderboardBackend::rebuildCounts()
+{
+    for (int attempt = 0; attempt < kMaxWriteAttempts; ++attempt) {
+        // The histogram's ETag before the table is read: a submit
+        // counted in between fails the write, and it is read again
+        auto current = startGet(QUrl(countsUrl()), 0);
+        wait(current);
+        auto table = startGet(QUrl(baseUrl + ".json"), 0);
+        wait(table);
+        if (!current->ok || !table->ok)
+            return false;
+
+        QHash<int, int> perScore;
+        const QJsonObject records = QJsonDocument::fromJson(table->body).object();
+        for (auto it = records.constBegin(); it != records.constEnd(); ++it) {
+            const QJsonObject record = it.value().toObject();
+            if (record.contains("score"))
+                ++perScore[record["score"].toInt()];
+        }
+
+        QJsonObject counts;
+        counts[kSeededKey] = true;
+        for (auto it = perScore.constBegin(); it != perScore.constEnd(); ++it)
+            counts[countKey(it.key())] = it.value();
+
+        QNetworkRequest req = makeRequest(QUrl(countsUrl()));
+        req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+        req.setRawHeader("if-match", current->etag.isEmpty() ? QByteArray(kNullEtag) : current->etag);
+        QNetworkReply *rep = net.put(req, QJsonDocument(counts).toJson(QJsonDocument::Compact));
+
+        QEventLoop loop;
+        QObject::connect(rep, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+        loop.exec();
+
+        const int status = rep->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        const QNetworkReply::NetworkError error = rep->error();
+        const QString errorText = rep->errorString();
+        rep->deleteLater();
+
+        if (status == 412)
+            continue;
+        if (error != QNetworkReply::NoError) {
+            qDebug() << "LEADERBOARD RECOUNT FAILED:" << errorText;
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+QVector<ScoreEntry> RestLeaderboardBackend::around(const QString &uniqueID, int k)
+{
+    int score = 0;
+    QString name;
+    if (!fetchRecord(uniqueID, score, name))
+        return {};
+
+    const int rank = rankForScore(score);
+
+    // Player, ties and the next better scores / the next k worse scores
+    QVector<ScoreEntry> above = fetchQuery(
+        QString("orderBy=\"score\"&startAt=%1&limitToFirst=%2").arg(score).arg(k + 1), k + 1);
+    QVector<ScoreEntry> below = fetchQuery(
+        QString("orderBy=\"score\"&endAt=%1&limitToLast=%2").arg(score - 1).arg(k), k);
+
+    QVector<ScoreEntry> window = above + below;
+    std::stable_sort(window.begin(), window.end(),
+                     [](const ScoreEntry &a, const ScoreEntry &b) { return a.score > b.score; });
+
+    // Put the player first among equal scores, matching rankForScore().
+    // With more ties than the query returned it may not be among them.
+    int me = 0;
+    while (me < window.size() && window[me].score > score)
+        ++me;
+    int i = me;
+    while (i < window.size() && window[i].score == score && window[i].id != uniqueID)
+        ++i;
+    if (i < window.size() && window[i].id == uniqueID)
+        std::rotate(window.begin() + me, window.begin() + i, window.begin() + i + 1);
+    else
+        window.insert(me, { name, score, 0, uniqueID });
+
+    int first = qMax(0, me - k);
+    window = window.mid(first, me - first + k + 1);
+    if (rank > 0)
+        assignRanks(window, rank - (me - first));
+    return window;
+}
+
+// ======================================================
+// IN-MEMORY
+// ======================================================
+MemoryLeaderboardBackend::MemoryLeaderboardBackend() = default;
+
+void MemoryLeaderboardBackend::submit(const QString &uniqueID, const QString &name, int score)
+{
+    auto it = slots.constFind(uniqueID);
+    if (it == slots.constEnd()) {
+        quint32 slot = quint32(records.size());
+        records.append({ uniqueID, name, score });
+        slots.insert(uniqueID, slot);
+        index.insert(score, slot);
+        return;
+    }
+
+    Record &r = records[*it];
+    if (!needsWrite(r.score, r.name, score, name))
+        return;
+
+    index.erase(r.score, *it);
+    r.name = name;
+    r.score = score;
+    index.insert(score, *it);
+}
+
+QVector<ScoreEntry> MemoryLeaderboardBackend::top(int count)
+{
+    QVector<quint32> found;
+    found.reserve(count);
+    index.collect(0, count, found);
+
+    QVector<ScoreEntry> result;
+    result.reserve(found.size());
+    for (quint32 slot : found)
+        result.append({ records[slot].name, records[slot].score, 0, records[slot].id });
+    assignRanks(result, 1);
+    return result;
+}
+
+int MemoryLeaderboardBackend::rankOf(const QString &uniqueID)
+{
+    auto it = slots.constFind(uniqueID);
+    if (it == slots.constEnd())
+        return 0;
+    return index.countAbove(records[*it].score) + 1;
+}
+
+QVector<ScoreEntry> MemoryLeaderboardBackend::around(const QString &uniqueID, int k)
+{
+    auto it = slots.constFind(uniqueID);
+    if (it == slots.constEnd())
+        return {};
+
+    int pos = index.position(records[*it].score, *it);
+    QVector<quint32> found;
+    found.reserve(2 * k + 1);
+    index.collect(pos - k, 2 * k + 1, found);
+
+    QVector<ScoreEntry> result;
+    result.reserve(found.size());
+    for (quint32 slot : found)
+        result.append({ records[slot].name, records[slot].score, 0, records[slot].id });
+    if (!result.isEmpty())
+        assignRanks(result, index.countAbove(result.first().score) + 1);
+    return result;
+}
+
+// ======================================================
+// LOCAL (memory-mapped file)
+// ======================================================
+static const char kLocalMagic[4] = { 'E', 'G', 'G', 'L' };
+static const quint32 kLocalVersion = 1;
+static const quint32 kInitialCapacity = 1024;
+
+LocalLeaderboardBackend::LocalLeaderboardBackend(const QString &path)
+    : file(path)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    if (!file.open(QIODevice::ReadWrite)) {
+        qDebug() << "FAILED TO OPEN LEADERBOARD:" << path;
+        return;
+    }
+
+    // ---- Fresh file: write an empty header ----
+    if (file.size() < qint64(sizeof(DiskHeader))) {
+        DiskHeader h;
+        memcpy(h.magic, kLocalMagic, 4);
+        h.version = kLocalVersion;
+        h.count = 0;
+        h.capacity = 0;
+        file.resize(0);
+        file.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        file.flush();
+    }
+
+    DiskHeader h;
+    file.seek(0);
+    file.read(reinterpret_cast<char *>(&h), sizeof(h));
+    if (memcmp(h.magic, kLocalMagic, 4) != 0 || h.version != kLocalVersion) {
+        qDebug() << "NOT A LEADERBOARD FILE:" << path;
+        return;
+    }
+
+    if (!remap(qMax(h.capacity, kInitialCapacity)))
+        return;
+
+    // ---- Rebuild the rank index from the records ----
+    quint32 count = qMin(header()->count, header()->capacity);
+    slots.reserve(int(count));
+    index.reserve(int(count));
+    for (quint32 slot = 0; slot < count; ++slot) {
+        const DiskRecord *r = record(slot);
+        slots.insert(idOf(*r), slot);
+        index.insert(r->score, slot);
+    }
+}
+
+LocalLeaderboardBackend::~LocalLeaderboardBackend()
+{
+    if (mapped)
+        file.unmap(mapped);
+}
+
+bool LocalLeaderboardBackend::remap(quint32 capacity)
+{
+    if (mapped) {
+        file.unmap(mapped);
+        mapped = nullptr;
+    }
+
+    qint64 bytes = qint64(sizeof(DiskHeader)) + qint64(capacity) * qint64(sizeof(DiskRecord));
+    if (file.size() < bytes && !file.resize(bytes))
+        return false;
+
+    mapped = file.map(0, bytes);
+    if (!mapped)
+        return false;
+
+    header()->capacity = capacity;
+    return true;
+}
+
+QString LocalLeaderboardBackend::idOf(const DiskRecord &r)
+{
+    return QString::fromLatin1(r.id, int(strnlen(r.id, sizeof(r.id))));
+}
+
+QString LocalLeaderboardBackend::nameOf(const DiskRecord &r)
+{
+    return QString::fromUtf8(r.name, int(strnlen(r.name, sizeof(r.name))));
+}
+
+void LocalLeaderboardBackend::submit(const QString &uniqueID, const QString &name, int score)
+{
+    if (!mapped)
+        return;
+
+    QByteArray nameBytes = name.toUtf8();
+    // Cut at a character boundary so the stored name stays valid UTF-8
+    int len = qMin<int>(nameBytes.size(), sizeof(DiskRecord::name));
+    while (len > 0 && len < nameBytes.size() && (uchar(nameBytes[len]) & 0xC0) == 0x80)
+        --len;
+
+    auto it = slots.constFind(uniqueID);
+    bool isNew = (it == slots.constEnd());
+    quint32 slot;
+
+    if (isNew) {
+        slot = header()->count;
+        if (slot >= header()->capacity && !remap(header()->capacity * 2))
+            return;
+
+        DiskRecord *r = record(slot);
+        memset(r, 0, sizeof(DiskRecord));
+        QByteArray id = uniqueID.toLatin1().left(sizeof(r->id));
+        memcpy(r->id, id.constData(), id.size());
+    } else {
+        slot = *it;
+        DiskRecord *r = record(slot);
+        if (!needsWrite(r->score, nameOf(*r), score, name))
+            return;
+        index.erase(r->score, slot);
+    }
+
+    DiskRecord *r = record(slot);
+    memset(r->name, 0, sizeof(r->name));
+    memcpy(r->name, nameBytes.constData(), len);
+    r->score = score;
+    index.insert(score, slot);
+
+    // Publish the record only once it is fully written
+    if (isNew) {
+        slots.insert(uniqueID, slot);
+        header()->count = slot + 1;
+    }
+}
+
+QVector<ScoreEntry> LocalLeaderboardBackend::top(int count)
+{
+    QVector<quint32> found;
+    found.reserve(count);
+    index.collect(0, count, found);
+
+    QVector<ScoreEntry> result;
+    result.reserve(found.size());
+    for (quint32 slot : found)
+        result.append({ nameOf(*record(slot)), record(slot)->score, 0, idOf(*record(slot)) });
+    assignRanks(result, 1);
+    return result;
+}
+
+int LocalLeaderboardBackend::rankOf(const QString &uniqueID)
+{
+    auto it = slots.constFind(uniqueID);
+    if (it == slots.constEnd())
+        return 0;
+    return index.countAbove(record(*it)->score) + 1;
+}
+
+QVector<ScoreEntry> LocalLeaderboardBackend::around(const QString &uniqueID, int k)
+{
+    auto it = slots.constFind(uniqueID);
+    if (it == slots.constEnd())
+        return {};
+
+    int pos = index.position(record(*it)->score, *it);
+    QVector<quint32> found;
+    found.reserve(2 * k + 1);
+    index.collect(pos - k, 2 * k + 1, found);
+
+    QVector<ScoreEntry> result;
+    result.reserve(found.size());
+    for (quint32 slot : found)
+        result.append({ nameOf(*record(slot)), record(slot)->score, 0, idOf(*record(slot)) });
+    if (!result.isEmpty())
+        assignRanks(result, index.countAbove(result.first().score) + 1);
+    return result;
+}
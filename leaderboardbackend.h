@@ -0,0 +1,182 @@
+#ifndef LEADERBOARDBACKEND_H
+#define LEADERBOARDBACKEND_H
+
+#include <QFile>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+#include "rankindex.h"
+
+struct ScoreEntry {
+    QString name;
+    int score;
+    int rank = 0;      // 1-based, ties share a rank; 0 when not known
+    QString id;        // the record's uniqueID
+};
+
+// ======================================================
+// Storage behind LeaderboardManager
+// ======================================================
+class LeaderboardBackend
+{
+public:
+    virtual ~LeaderboardBackend() = default;
+
+    // Insert or update a player's record
+    virtual void submit(const QString &uniqueID, const QString &name, int score) = 0;
+    // Best `count` entries, highest score first
+    virtual QVector<ScoreEntry> top(int count) = 0;
+    // 1-based rank of the player, 0 when unknown
+    virtual int rankOf(const QString &uniqueID) = 0;
+    // The player plus up to k neighbours on each side, highest first;
+    // the player's entry is the one whose id is uniqueID
+    virtual QVector<ScoreEntry> around(const QString &uniqueID, int k) = 0;
+    // Optional: open connections/files ahead of the first request
+    // (LeaderboardManager::warmUp, after the first menu frame)
+    virtual void warmUp() {}
+
+protected:
+    // Same rule for every backend: skip the write only if nothing changed
+    static bool needsWrite(int oldScore, const QString &oldName, int score, const QString &name)
+    {
+        return score > oldScore || oldName != name;
+    }
+
+    // Fill ranks of a contiguous, sorted window whose first entry has `firstRank`
+    static void assignRanks(QVector<ScoreEntry> &window, int firstRank);
+};
+
+/* -------------------------------------------------------------
+   Firebase realtime database over REST
+--------------------------------------------------------------*/
+class RestLeaderboardBackend : public LeaderboardBackend
+{
+public:
+    static constexpr int kReadChunk = 16 * 1024;
+    static constexpr int kMaxWriteAttempts = 3;
+
+    // baseUrl is the leaderboard node, e.g. https://host/leaderboard
+    explicit RestLeaderboardBackend(const QString &baseUrl);
+    ~RestLeaderboardBackend() override;
+
+    void submit(const QString &uniqueID, const QString &name, int score) override;
+    QVector<ScoreEntry> top(int count) override;
+    int rankOf(const QString &uniqueID) override;
+    QVector<ScoreEntry> around(const QString &uniqueID, int k) override;
+    void warmUp() override;
+
+    // Recounts the score histogram from a full read of the table.
+    // Needed once for a table that predates it, and again if it
+    // went wrong (a client gone between record and count write,
+    // an old client that never counts); false if it could not.
+    bool rebuildCounts();
+
+private:
+    struct PendingGet;
+
+    // Last value and ETag seen for a record, makes writes conditional
+    struct Known {
+        QByteArray etag;
+        bool exists = false;
+        int score = -1;
+        QString name;
+    };
+
+    QString recordUrl(const QString &uniqueID) const;
+    QString countsUrl() const;
+    QNetworkRequest makeRequest(const QUrl &url) const;
+    // keep > 0 streams a query into a top-`keep` parser, 0 buffers a record
+    std::shared_ptr<PendingGet> startGet(const QUrl &url, int keep);
+    void wait(const std::shared_ptr<PendingGet> &get);
+    void remember(const QString &uniqueID, const QByteArray &etag, const QByteArray &body);
+
+    bool fetchRecord(const QString &uniqueID, int &score, QString &name);
+    // 0 when the histogram cannot be read or is not seeded
+    int rankForScore(int score);
+    // One record moved from score `from` (-1: new record) to `to`
+    void moveCount(int from, int to);
+    // Streams an indexed query (orderBy="score" + extra params), keeps the best `keep`
+    QVector<ScoreEntry> fetchQuery(const QString &params, int keep);
+
+    QNetworkAccessManager net;
+    QString baseUrl;
+    QHash<QString, std::shared_ptr<PendingGet>> pending;   // in-flight GETs by URL
+    QHash<QString, Known> known;
+};
+
+/* -------------------------------------------------------------
+   Process-local table, for tests and offline play
+--------------------------------------------------------------*/
+class MemoryLeaderboardBackend : public LeaderboardBackend
+{
+public:
+    MemoryLeaderboardBackend();
+
+    void submit(const QString &uniqueID, const QString &name, int score) override;
+    QVector<ScoreEntry> top(int count) override;
+    int rankOf(const QString &uniqueID) override;
+    QVector<ScoreEntry> around(const QString &uniqueID, int k) override;
+
+private:
+    struct Record {
+        QString id;
+        QString name;
+        int score;
+    };
+
+    QVector<Record> records;          // indexed by slot
+    QHash<QString, quint32> slots;
+    RankIndex index;
+};
+
+/* -------------------------------------------------------------
+   Embedded on-disk table: fixed-size records in a memory-mapped
+   file, ranked through an in-memory RankIndex built at open.
+--------------------------------------------------------------*/
+class LocalLeaderboardBackend : public LeaderboardBackend
+{
+public:
+    explicit LocalLeaderboardBackend(const QString &path);
+    ~LocalLeaderboardBackend() override;
+
+    bool isOpen() const { return mapped != nullptr; }
+
+    void submit(const QString &uniqueID, const QString &name, int score) override;
+    QVector<ScoreEntry> top(int count) override;
+    int rankOf(const QString &uniqueID) override;
+    QVector<ScoreEntry> around(const QString &uniqueID, int k) override;
+
+private:
+    struct DiskHeader {
+        char magic[4];
+        quint32 version;
+        quint32 count;
+        quint32 capacity;
+    };
+
+    struct DiskRecord {
+        char id[40];
+        char name[36];     // UTF-8, NUL padded
+        qint32 score;
+    };
+
+    bool remap(quint32 capacity);
+    DiskHeader *header() const { return reinterpret_cast<DiskHeader *>(mapped); }
+    DiskRecord *record(quint32 slot) const
+    {
+        return reinterpret_cast<DiskRecord *>(mapped + sizeof(DiskHeader)) + slot;
+    }
+    static QString idOf(const DiskRecord &r);
+    static QString nameOf(const DiskRecord &r);
+
+    QFile file;
+    uchar *mapped = nullptr;
+    QHash<QString, quint32> slots;
+    RankIndex index;
+};
+
+#endif // LEADERBOARDBACKEND_H
@@ -1,78 +1,54 @@
-#include "LeaderboardManager.h"
-#include <QNetworkReply>
-#include <QEventLoop>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <algorithm>
+#include "leaderboardmanager.h"
+
+#include <QStandardPaths>
+
+static const char *kDefaultRestUrl =
+    "https://eggcatcher-7e326-default-rtdb.firebaseio.com/leaderboard";
 
 LeaderboardManager::LeaderboardManager(QObject *parent)
-    : QObject(parent)
+    : QObject(parent),
+    backend(createBackend(qEnvironmentVariable("EGGCATCHER_LEADERBOARD")))
 {
-    firebaseUrl =
-        "https://eggcatcher-7e326-default-rtdb.firebaseio.com/leaderboard.json";
 }
 
-/* -------------------------------------------------------------
-   ADD OR UPDATE PLAYER SCORE
---------------------------------------------------------------*/
-void LeaderboardManager::addScore(const QString &uniqueID,
-                                  const QString &name,
-                                  int score)
+std::unique_ptr<LeaderboardBackend> LeaderboardManager::createBackend(const QString &spec)
 {
-    QString recordUrl =
-        QString("https://eggcatcher-7e326-default-rtdb.firebaseio.com/leaderboard/%1.json")
-            .arg(uniqueID);
-
-    int oldScore = -1;
-    QString oldName;
-
-    // ---- READ EXISTING RECORD ----
-    {
-        QNetworkRequest getReq(recordUrl);
-        QEventLoop loop;
-        QNetworkReply *rep = net.get(getReq);
-
-        connect(rep, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-        loop.exec();
-
-        if (rep->error() == QNetworkReply::NoError) {
-            QJsonObject obj = QJsonDocument::fromJson(rep->readAll()).object();
-
-            if (obj.contains("score"))
-                oldScore = obj["score"].toInt();
-
-            if (obj.contains("name"))
-                oldName = obj["name"].toString();
-        }
-
-        rep->deleteLater();
+    if (spec == "memory")
+        return std::make_unique<MemoryLeaderboardBackend>();
+
+    if (spec == "local" || spec.startsWith("local:")) {
+        QString path = spec.mid(6);
+        if (path.isEmpty())
+            path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                   + "/leaderboard.bin";
+        return std::make_unique<LocalLeaderboardBackend>(path);
     }
 
-    // ---- UPDATE RULES ----
-    bool scoreNotImproved = (score <= oldScore);
-    bool nameSame = (oldName == name);
-
-    // Skip update ONLY if nothing changed
-    if (scoreNotImproved && nameSame) {
-        return;
-    }
+    if (spec.startsWith("rest:"))
+        return std::make_unique<RestLeaderboardBackend>(spec.mid(5));
 
-    // ---- WRITE NEW RECORD ----
-    QJsonObject data;
-    data["name"] = name;
-    data["score"] = score;
-
-    QNetworkRequest req(recordUrl);
-    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    return std::make_unique<RestLeaderboardBackend>(kDefaultRestUrl);
+}
 
-    QNetworkReply *rep = net.put(req, QJsonDocument(data).toJson());
+void LeaderboardManager::setBackend(std::unique_ptr<LeaderboardBackend> newBackend)
+{
+    backend = std::move(newBackend);
+    cachedScores.clear();
+}
 
-    QEventLoop loop;
-    connect(rep, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-    loop.exec();
+void LeaderboardManager::warmUp()
+{
+    backend->warmUp();
+}
 
-    rep->deleteLater();
+/* -------------------------------------------------------------
+   ADD OR UPDATE PLAYER SCORE
+--------------------------------------------------------------*/
+void LeaderboardManager::addScore(const QString &uniqueID,
+                                  const QString &name,
+                                  int score)
+{
+    backend->submit(uniqueID, name, score);
 }
 
 
@@ -81,48 +57,15 @@ void LeaderboardManager::addScore(const QString &uniqueID,
 --------------------------------------------------------------*/
 QVector<ScoreEntry> LeaderboardManager::loadScores()
 {
-    cachedScores.clear();
-    fetchScores();
+    cachedScores = backend->top(kTopEntries);
     return cachedScores;
 }
 
 
 /* -------------------------------------------------------------
-   Internal: fetch scores from firebase REST
+   RANK / AROUND ME
 --------------------------------------------------------------*/
-void LeaderboardManager::fetchScores()
+QVector<ScoreEntry> LeaderboardManager::loadAround(const QString &uniqueID, int k)
 {
-    QNetworkRequest req(firebaseUrl);
-    QEventLoop loop;
-
-    QNetworkReply *rep = net.get(req);
-    connect(rep, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-    loop.exec();
-
-    if (rep->error() != QNetworkReply::NoError) {
-        rep->deleteLater();
-        return;
-    }
-
-    QByteArray raw = rep->readAll();
-    rep->deleteLater();
-
-    QJsonDocument doc = QJsonDocument::fromJson(raw);
-    if (!doc.isObject()) return;
-
-    QJsonObject root = doc.object();
-
-    cachedScores.clear();
-    for (auto it = root.begin(); it != root.end(); ++it) {
-        QJsonObject obj = it.value().toObject();
-
-        ScoreEntry e;
-        e.name = obj["name"].toString();
-        e.score = obj["score"].toInt();
-        cachedScores.push_back(e);
-    }
-
-    // Sort in descending order
-    std::sort(cachedScores.begin(), cachedScores.end(),
-              [](auto &a, auto &b) { return a.score > b.score; });
+    return backend->around(uniqueID, k);
 }
@@ -2,33 +2,44 @@
 #define LEADERBOARDMANAGER_H
 
 #include <QObject>
-#include <QNetworkAccessManager>
 #include <QVector>
+#include <memory>
 
-struct ScoreEntry {
-    QString name;
-    int score;
-};
+#include "leaderboardbackend.h"
 
 class LeaderboardManager : public QObject
 {
     Q_OBJECT
 
 public:
+    static constexpr int kTopEntries = 50;      // records kept from a fetch
+
+    // Backend comes from EGGCATCHER_LEADERBOARD:
+    //   unset / "rest"     Firebase at the default URL
+    //   "rest:<url>"       another REST node (on-prem, test server)
+    //   "local:<path>"     embedded memory-mapped table
+    //   "memory"           in-process table
     explicit LeaderboardManager(QObject *parent = nullptr);
 
+    static std::unique_ptr<LeaderboardBackend> createBackend(const QString &spec);
+    void setBackend(std::unique_ptr<LeaderboardBackend> backend);
+
+    // Pre-open the backend's connection. Not done at construction:
+    // MainWindow::loadDeferredAssets calls it once the first menu
+    // frame is up, so it overlaps the menu rather than the launch
+    void warmUp();
+
     // Push score
     void addScore(const QString &uniqueID, const QString &name, int score);
 
     // Load sorted scores
     QVector<ScoreEntry> loadScores();
 
-private:
-    void fetchScores();
+    // The player's entry (rank filled in) and the +/- k around it
+    QVector<ScoreEntry> loadAround(const QString &uniqueID, int k);
 
 private:
-    QNetworkAccessManager net;
-    QString firebaseUrl;
+    std::unique_ptr<LeaderboardBackend> backend;
     QVector<ScoreEntry> cachedScores;
 };
 
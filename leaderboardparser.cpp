@@ -0,0 +1,242 @@
+#include "leaderboardparser.h"
+
+#include <algorithm>
+
+static bool scoreGreater(const ScoreEntry &a, const ScoreEntry &b)
+{
+    return a.score > b.score;   // min-heap comparator
+}
+
+static bool isScalarChar(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+           || c == '+' || c == '-' || c == '.';
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+LeaderboardStreamParser::LeaderboardStreamParser(int topK)
+    : topK(qMax(1, topK))
+{
+    heap.reserve(this->topK);
+    token.reserve(64);
+    recordId.reserve(40);
+    recordName.reserve(32);
+}
+
+/* -------------------------------------------------------------
+   FEED: one pass over the chunk, state carries across chunks
+--------------------------------------------------------------*/
+void LeaderboardStreamParser::feed(const char *data, qsizetype size)
+{
+    for (qsizetype i = 0; i < size && !error; ++i) {
+        const char c = data[i];
+
+        switch (lex) {
+        case Lex::String:
+            if (c == '"') {
+                lex = Lex::Idle;
+                finishString();
+            } else if (c == '\\') {
+                lex = Lex::StringEscape;
+            } else {
+                token.append(c);
+            }
+            continue;
+
+        case Lex::StringEscape:
+            lex = Lex::String;
+            switch (c) {
+            case '"': case '\\': case '/': token.append(c); break;
+            case 'b': token.append('\b'); break;
+            case 'f': token.append('\f'); break;
+            case 'n': token.append('\n'); break;
+            case 'r': token.append('\r'); break;
+            case 't': token.append('\t'); break;
+            case 'u':
+                lex = Lex::StringUnicode;
+                unicode = 0;
+                unicodeDigits = 0;
+                break;
+            default: fail(); break;
+            }
+            continue;
+
+        case Lex::StringUnicode: {
+            int v = hexValue(c);
+            if (v < 0) {
+                fail();
+                continue;
+            }
+            unicode = unicode * 16 + uint(v);
+            if (++unicodeDigits == 4) {
+                appendCodePoint(unicode);
+                lex = Lex::String;
+            }
+            continue;
+        }
+
+        case Lex::Scalar:
+            if (isScalarChar(c)) {
+                token.append(c);
+                continue;
+            }
+            lex = Lex::Idle;
+            finishScalar();
+            break;   // c still needs handling below
+
+        case Lex::Idle:
+            break;
+        }
+
+        // ---- Idle: structure and token starts ----
+        switch (c) {
+        case ' ': case '\t': case '\n': case '\r':
+            break;
+        case '{':
+            stack.append('{');
+            expectKey = true;
+            if (stack.size() == 2 && stack[0] == '{') {
+                recordName.resize(0);
+                recordScore = 0;
+                recordHasScore = false;
+            }
+            break;
+        case '[':
+            stack.append('[');
+            expectKey = false;
+            break;
+        case '}':
+        case ']':
+            if (stack.isEmpty() || stack.last() != (c == '}' ? '{' : '[')) {
+                fail();
+                break;
+            }
+            if (c == '}' && stack.size() == 2 && stack[0] == '{')
+                endRecord();
+            stack.removeLast();
+            expectKey = false;
+            break;
+        case ':':
+            break;
+        case ',':
+            expectKey = !stack.isEmpty() && stack.last() == '{';
+            break;
+        case '"':
+            token.resize(0);
+            highSurrogate = 0;
+            lex = Lex::String;
+            break;
+        default:
+            if (!isScalarChar(c)) {
+                fail();
+                break;
+            }
+            token.resize(0);
+            token.append(c);
+            lex = Lex::Scalar;
+            break;
+        }
+    }
+}
+
+QVector<ScoreEntry> LeaderboardStreamParser::takeTop()
+{
+    if (lex == Lex::Scalar) {
+        lex = Lex::Idle;
+        finishScalar();
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), scoreGreater);   // highest first
+    QVector<ScoreEntry> top(heap.begin(), heap.end());
+    heap.clear();
+    return top;
+}
+
+/* -------------------------------------------------------------
+   Internal helpers
+--------------------------------------------------------------*/
+void LeaderboardStreamParser::finishString()
+{
+    if (expectKey) {
+        expectKey = false;
+        if (stack.size() == 1) {
+            field = Field::Id;
+            recordId.resize(0);
+            recordId.append(token);
+        }
+        else if (stack.size() == 2)
+            field = (token == "name") ? Field::Name
+                    : (token == "score") ? Field::Score
+                    : Field::Other;
+        return;
+    }
+
+    if (stack.size() == 2 && field == Field::Name) {
+        recordName.resize(0);
+        recordName.append(token);
+    }
+}
+
+void LeaderboardStreamParser::finishScalar()
+{
+    if (stack.size() == 2 && field == Field::Score) {
+        bool ok = false;
+        double v = token.toDouble(&ok);
+        if (ok) {
+            recordScore = int(v);
+            recordHasScore = true;
+        }
+    }
+}
+
+void LeaderboardStreamParser::appendCodePoint(uint cp)
+{
+    if (cp >= 0xD800 && cp <= 0xDBFF) {
+        highSurrogate = cp;
+        return;
+    }
+    if (cp >= 0xDC00 && cp <= 0xDFFF && highSurrogate) {
+        cp = 0x10000 + ((highSurrogate - 0xD800) << 10) + (cp - 0xDC00);
+        highSurrogate = 0;
+    }
+
+    if (cp < 0x80) {
+        token.append(char(cp));
+    } else if (cp < 0x800) {
+        token.append(char(0xC0 | (cp >> 6)));
+        token.append(char(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        token.append(char(0xE0 | (cp >> 12)));
+        token.append(char(0x80 | ((cp >> 6) & 0x3F)));
+        token.append(char(0x80 | (cp & 0x3F)));
+    } else {
+        token.append(char(0xF0 | (cp >> 18)));
+        token.append(char(0x80 | ((cp >> 12) & 0x3F)));
+        token.append(char(0x80 | ((cp >> 6) & 0x3F)));
+        token.append(char(0x80 | (cp & 0x3F)));
+    }
+}
+
+void LeaderboardStreamParser::endRecord()
+{
+    ++records;
+    field = Field::Other;
+    if (!recordHasScore)
+        return;
+
+    if (int(heap.size()) < topK) {
+        heap.push_back({ QString::fromUtf8(recordName), recordScore, 0, QString::fromUtf8(recordId) });
+        std::push_heap(heap.begin(), heap.end(), scoreGreater);
+    } else if (recordScore > heap.front().score) {
+        std::pop_heap(heap.begin(), heap.end(), scoreGreater);
+        heap.back() = { QString::fromUtf8(recordName), recordScore, 0, QString::fromUtf8(recordId) };
+        std::push_heap(heap.begin(), heap.end(), scoreGreater);
+    }
+}
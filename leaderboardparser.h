@@ -0,0 +1,68 @@
+#ifndef LEADERBOARDPARSER_H
+#define LEADERBOARDPARSER_H
+
+#include <QByteArray>
+#include <QVector>
+#include <vector>
+
+#include "leaderboardbackend.h"
+
+// ======================================================
+// Incremental parser for the leaderboard payload
+//
+//   { "<id>": { "name": "...", "score": N, ... }, ... }
+//
+// Chunks are fed as they arrive from the network. Only the best K
+// records are kept (min-heap), names are turned into QStrings only
+// when a record makes it into the heap.
+// ======================================================
+class LeaderboardStreamParser
+{
+public:
+    explicit LeaderboardStreamParser(int topK);
+
+    void feed(const char *data, qsizetype size);
+    void feed(const QByteArray &chunk) { feed(chunk.constData(), chunk.size()); }
+
+    bool failed() const { return error; }
+    qint64 recordCount() const { return records; }
+
+    // Best entries, highest score first
+    QVector<ScoreEntry> takeTop();
+
+private:
+    enum class Lex : quint8 { Idle, String, StringEscape, StringUnicode, Scalar };
+    enum class Field : quint8 { Other, Id, Name, Score };
+
+    void finishString();
+    void finishScalar();
+    void appendCodePoint(uint cp);
+    void endRecord();
+    void fail() { error = true; }
+
+    int topK;
+    std::vector<ScoreEntry> heap;   // min-heap on score
+
+    // lexer state
+    Lex lex = Lex::Idle;
+    QByteArray token;               // current string / scalar bytes
+    uint unicode = 0;
+    int unicodeDigits = 0;
+    uint highSurrogate = 0;
+
+    // structure state
+    QVector<char> stack;            // '{' or '['
+    bool expectKey = false;
+    Field field = Field::Other;
+
+    // current record
+    QByteArray recordId;
+    QByteArray recordName;
+    int recordScore = 0;
+    bool recordHasScore = false;
+
+    qint64 records = 0;
+    bool error = false;
+};
+
+#endif // LEADERBOARDPARSER_H
@@ -1,11 +1,16 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QElapsedTimer>
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer launch;
+    launch.start();
+
     QApplication a(argc, argv);
     MainWindow w;
+    w.setLaunchClock(launch);
     w.show();
     return a.exec();
 }
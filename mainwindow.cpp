@@ -12,127 +12,38 @@
 #include <QFile>
 #include <QTextStream>
 #include <QDir>
-
-// ======================================================
-// PIXELATED EGG SHAPE DRAWING FUNCTION (Unchanged)
-// ======================================================
-static void drawEggShape(QPainter &p, int cx, int cy, int box)
+#include <QFontMetricsF>
+#include <QDateTime>
+#include <QResizeEvent>
+#include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QWindow>
+
+#ifdef Q_OS_WIN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// User + system CPU time of the whole process, all threads
+static qint64 processCpuMs()
 {
-    p.setBrush(Qt::white);
-    p.setPen(Qt::NoPen);
-
-    auto plot = [&](int gx, int gy){
-        p.fillRect(gx * box, gy * box, box, box, Qt::white);
+#ifdef Q_OS_WIN
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+        return 0;
+    auto ms = [](const FILETIME &t) {
+        return qint64((quint64(t.dwHighDateTime) << 32 | t.dwLowDateTime) / 10000);
     };
-
-    /* ======================================================
-       SEMICIRCLE BOTTOM
-       (midpoint circle)
-    ====================================================== */
-    int r = box;
-    int x = 0;
-    int y = r;
-    int d = 1 - r;
-
-    QVector<QPoint> boundary;
-
-    while (x <= y)
-    {
-        int px[4] = { x,  y, -x, -y };
-        int py[4] = { y,  x,  y,  x };
-
-        for (int i = 0; i < 4; i++)
-        {
-            int gx = cx + px[i];
-            int gy = cy + py[i];
-            if (gy >= cy)
-                boundary.push_back({gx, gy});
-        }
-
-        x++;
-        if (d < 0) d += 2*x + 1;
-        else { y--; d += 2*(x - y) + 1; }
-    }
-
-    /* ======================================================
-       TOP ELLIPSE
-       (midpoint ellipse)
-    ====================================================== */
-    int rx = box;
-    int ry = box * 1.5;
-    int rx2 = rx * rx;
-    int ry2 = ry * ry;
-    int ex = 0;
-    int ey = ry;
-
-    float d1 = ry2 - rx2 * ry + (0.25f * rx2);
-    int dx = 2 * ry2 * ex;
-    int dy = 2 * rx2 * ey;
-
-    while (dx < dy)
-    {
-        boundary.push_back({cx + ex, cy - ey});
-        boundary.push_back({cx - ex, cy - ey});
-
-        if (d1 < 0) {
-            ex++;
-            dx += 2*ry2;
-            d1 += dx + ry2;
-        } else {
-            ex++; ey--;
-            dx += 2*ry2;
-            dy -= 2*rx2;
-            d1 += dx - dy + ry2;
-        }
-    }
-
-    float d2 =
-        (ry2)*(ex+0.5f)*(ex+0.5f) +
-        (rx2)*(ey-1)*(ey-1) -
-        (rx2*ry2);
-
-    while (ey >= 0)
-    {
-        boundary.push_back({cx + ex, cy - ey});
-        boundary.push_back({cx - ex, cy - ey});
-
-        if (d2 > 0) {
-            ey--;
-            dy -= 2*rx2;
-            d2 += rx2 - dy;
-        } else {
-            ey--; ex++;
-            dx += 2*ry2;
-            dy -= 2*rx2;
-            d2 += dx - dy + rx2;
-        }
-    }
-
-    /* ======================================================
-       FILL SCANLINES INSIDE
-    ====================================================== */
-    std::sort(boundary.begin(), boundary.end(),
-              [](auto &a, auto &b){
-                  return (a.y() == b.y()) ? a.x() < b.x() : a.y() < b.y();
-              });
-
-    int i = 0;
-    while (i < boundary.size())
-    {
-        int y = boundary[i].y();
-        QVector<int> xs;
-
-        while (i < boundary.size() && boundary[i].y() == y) {
-            xs.push_back(boundary[i].x());
-            i++;
-        }
-
-        std::sort(xs.begin(), xs.end());
-        for (int k = 0; k + 1 < xs.size(); k += 2) {
-            for (int xF = xs[k]; xF <= xs[k+1]; xF++)
-                plot(xF, y);
-        }
-    }
+    return ms(kernel) + ms(user);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto ms = [](const timeval &t) { return qint64(t.tv_sec) * 1000 + t.tv_usec / 1000; };
+    return ms(usage.ru_utime) + ms(usage.ru_stime);
+#endif
 }
 
 // ======================================================
@@ -144,42 +55,15 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
     ui(new Ui::MainWindow),
     leaderboardManager(), // Initialize LeaderboardManager
+    profileStore(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)),
+    sim(0, 0),
+    renderer(600, 6),
     gameTimer(nullptr),
     grid_box(6),
-    highScore(0),
     grid_size(600),
     cols(0),
     rows(0),
-    globalTime(0.0f),
-    globalSpawnTimer(0.0f),
-    spawnInterval(1.0f),
-    lastEdgeSpawnTime(-100.0f),
-    edgeSpawnCooldown(4.0f),
-    currentColumnIndex(0),
-    basket(0, 0),
-    prevBasketX(0.0f),
-    basketXVelocity(0.0f),
-    basketTargetVel(0.0f),
-    basketAccel(25.0f),
-    basketMaxVel(50.0f),
-    moveLeft(false),
-    moveRight(false),
-    fixedDelta(1.0f / 120.0f),
-    accumulator(0.0f),
-    gameOver(false),
-    gameRunning(false),
-    showMenu(true), // Initial state: Menu
-    showLeaderboard(false), // Initial state: Not Leaderboard
-    score(0),
-    lives(3),
-    flashAlpha(0.0f),
-    flashFadeSpeed(2.5f),
-    windActive(false),
-    windStrength(0.0f),
-    windTimer(0.0f),
-    windCooldown(8.0f),
-    timeSinceLastWind(0.0f),
-    focusMode(false)
+    accumulator(0.0f)
 {
     QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     qDebug() << dirPath;
@@ -192,67 +76,63 @@ MainWindow::MainWindow(QWidget *parent)
         if (grid_size <= 0)
             grid_size = 600;
     }
-    loadHighScore(); // Load local high score for HUD
     cols = qMax(40, grid_size / grid_box);
     rows = qMax(30, grid_size / grid_box);
+    sim = GameSimulation(cols, rows);
+    sim.onEvent = [this](GameEventKind kind, EggType type, float value, float x) {
+        onGameEvent(kind, type, value, x);
+    };
+    // EGGCATCHER_AUTOPLAY: the intercept bot plays instead of the keys
+    autoplay = qEnvironmentVariableIsSet("EGGCATCHER_AUTOPLAY");
+    if (autoplay)
+        sim.controller = &autoBot;
+    else
+        sim.controller = this;
+    renderer = GameRenderer(grid_size, grid_box);
+    loadHighScore(); // Load local high score for HUD
 
-    // background (simple green field)
-    background = QPixmap(grid_size, grid_size);
-    background.fill(QColor(48, 120, 48)); // nicer green
-    {
-        QPainter g(&background);
-        g.setPen(QPen(QColor(25, 100, 25, 80), 1));
-        for (int i = 0; i <= cols; ++i)
-            g.drawLine(i * grid_box, 0, i * grid_box, grid_size);
-        for (int j = 0; j <= rows; ++j)
-            g.drawLine(0, j * grid_box, grid_size, j * grid_box);
-    }
-    ui->frame->setPixmap(background);
-
-    score = 0;
-    lives = 3;
-    basket = QPointF(cols / 2.0f, rows - 3.0f);
-    prevBasketX = basket.x();
-
-    soundCatch.setSource(QUrl::fromLocalFile("C:/Projects/EggCatcher/sfx/catch.wav"));
-    soundCatch.setVolume(0.8f);
-    soundLose.setSource(QUrl::fromLocalFile("C:/Projects/EggCatcher/sfx/lose.wav"));
-    soundLose.setVolume(0.9f);
-
-    dropColumns.clear();
-    int mid = cols / 2;
-    dropColumns = {mid - 25, mid - 5, mid + 5, mid + 25};
-    std::sort(dropColumns.begin(), dropColumns.end());
-
-    columnTimers.resize(dropColumns.size());
-    columnDelays.resize(dropColumns.size());
-    for (int i = 0; i < dropColumns.size(); ++i) {
-        columnTimers[i] = 0.0f;
-        columnDelays[i] = 3.0f + QRandomGenerator::global()->bounded(2.0f);
-    }
+    // background (simple green field) and sprites, per size and DPR.
+    // The playfield stays grid_size logical units; only the pixels change.
+    assetCache = std::make_unique<AssetCache>(this, grid_size, grid_box);
+    assetCache->setOnReady([this](std::shared_ptr<const RenderAssets> assets) {
+        if (assets->side == canvasSide && assets->dpr == AssetCache::dprBucket(canvasDpr)) {
+            applyRenderAssets(std::move(assets));
+            requestFrame();   // an idle screen was drawn from the scaled fallback
+        }
+    });
+    canvasSide = grid_size;
+    canvasDpr = ui->frame->devicePixelRatioF();
+    applyRenderAssets(assetCache->buildNow(canvasSide, canvasDpr));
+    ui->frame->setPixmap(renderer.background());
+    rebuildRenderCache();
+
+    // Sound is decoded and started in loadDeferredAssets, after the first menu frame
+    audio.setMasterVolume(profileStore.profile().settings.sfxVolume);
 
     // Timer
     gameTimer = new QTimer(this);
     gameTimer->setTimerType(Qt::PreciseTimer);
     connect(gameTimer, &QTimer::timeout, this, &MainWindow::gameTick);
-    gameTimer->start(1000 / 60);  // ≈ 16.67 ms per frame
+    gameTimer->setInterval(1000 / 60);  // ≈ 16.67 ms per frame, runs only while animating
 
     frameClock.start();
 
+    // --- Input sources: keys come through key events, the rest here ---
+    inputClock.start();
+    gamepad = std::make_unique<GamepadInput>(inputQueue, inputClock, this);
+    ui->frame->setInputClock(&inputClock);   // mouse/touch are polled per step
+
     // --- MENU UI Setup ---
     playButton = new QPushButton("PLAY", ui->frame);
     leaderboardButton = new QPushButton("LEADERBOARD", ui->frame);
     nameInput = new QLineEdit(ui->frame);
     backToMenuButton = new QPushButton("Back to Menu", ui->frame);
+    aroundMeButton = new QPushButton("AROUND ME", ui->frame);
 
-    // Set retro-looking styles
-    QString buttonStyle = "QPushButton { font-size: 20px; color: yellow; background-color: #2a2a2a; border: 2px solid white; padding: 10px; } QPushButton:hover { background-color: #444444; }";
-    QString inputStyle = "QLineEdit { font-size: 18px; color: white; background-color: #2a2a2a; border: 2px solid #555555; padding: 8px; }";
-
-    playButton->setStyleSheet(buttonStyle);
-    leaderboardButton->setStyleSheet(buttonStyle);
-    backToMenuButton->setStyleSheet(buttonStyle);
-    nameInput->setStyleSheet(inputStyle);
+    // Set retro-looking styles: one sheet on the frame, parsed once for all children
+    QFile styleFile(":/styles/menu.qss");
+    if (styleFile.open(QIODevice::ReadOnly))
+        ui->frame->setStyleSheet(QString::fromUtf8(styleFile.readAll()));
     nameInput->setMaxLength(10);
     nameInput->setText(playerName);
 
@@ -261,17 +141,36 @@ MainWindow::MainWindow(QWidget *parent)
     leaderboardButton->setGeometry(220, 430, 160, 50);
     nameInput->setGeometry(200, 310, 200, 40);
     backToMenuButton->setGeometry(220, 570, 160, 50);
+    aroundMeButton->setGeometry(220, 510, 160, 50);
+
+    // Remember the layout in playfield units so it can follow the frame's size
+    for (QWidget *w : std::initializer_list<QWidget *>{ playButton, leaderboardButton, nameInput,
+                                                        backToMenuButton, aroundMeButton })
+        logicalGeometry.append({ w, w->geometry() });
 
     // Connect new signals
     connect(playButton, &QPushButton::clicked, this, &MainWindow::startGameButtonClicked);
     connect(leaderboardButton, &QPushButton::clicked, this, &MainWindow::showLeaderboardButtonClicked);
     connect(backToMenuButton, &QPushButton::clicked, [this](){
-        showLeaderboard = false;
-        showMenu = true;
+        setScreen(Screen::Menu);
+    });
+    connect(aroundMeButton, &QPushButton::clicked, [this](){
+        leaderboardAroundMe = !leaderboardAroundMe;
+        reloadLeaderboard();
     });
 
 
     nameInput->setText(playerName);
+    setScreen(Screen::Menu);   // first menu frame is posted, not a tick away
+
+    if (qEnvironmentVariableIsSet("EGGCATCHER_BROADCAST"))
+        broadcast = std::make_unique<BroadcastServer>(quint16(qEnvironmentVariableIntValue("EGGCATCHER_BROADCAST")), this);
+    const QString watch = qEnvironmentVariable("EGGCATCHER_WATCH");
+    if (!watch.isEmpty()) {
+        const int colon = watch.lastIndexOf(':');
+        viewer = std::make_unique<BroadcastViewer>(watch.left(colon), quint16(watch.mid(colon + 1).toUInt()), this);
+        setScreen(Screen::Playing);
+    }
 }
 
 MainWindow::~MainWindow()
@@ -282,131 +181,162 @@ MainWindow::~MainWindow()
 // ======================================================
 // HIGH SCORE PERSISTENCE (Local)
 // ======================================================
-#include <QUuid>
-QString MainWindow::getDeviceID()
+void MainWindow::loadHighScore()
 {
-    QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
-    + "/device_id.txt";
-
-    QFile f(path);
-
-    // Already exists → load
-    if (f.exists() && f.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QString id = f.readAll().trimmed();
-        f.close();
-        if (!id.isEmpty())
-            return id;
-    }
-
-    // Create new
-    QString newID = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    const Profile &profile = profileStore.profile();
+    deviceID = profile.deviceId;
+    playerName = profile.name;
+    sim.highScore = profile.highScore;
+}
 
-    if (f.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        f.write(newID.toUtf8());
-        f.close();
-    }
 
-    return newID;
+void MainWindow::saveHighScore()
+{
+    profileStore.setName(playerName);
+    profileStore.setHighScore(sim.highScore);
+    profileStore.save();   // atomic write on the store's worker thread
 }
 
 
-void MainWindow::loadHighScore()
-{
-    QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QDir().mkpath(dirPath);
+// ======================================================
+// INPUT HANDLING
+// ======================================================
 
-    QString filePath = dirPath + "/player_info.txt";
-    QFile file(filePath);
+void MainWindow::keyPressEvent(QKeyEvent *event)
+{
+    if (event->isAutoRepeat())
+        return;
 
-    if (!file.exists()) {
-        playerName = "Player";
-        highScore = 0;
+    if (screen == Screen::GameOver && event->key() == Qt::Key_R) {
+        // If game over, and R is pressed, reset the game
+        resetGame();
+        return;
+    }else if(screen == Screen::GameOver && event->key() == Qt::Key_M){
+        setScreen(Screen::Menu);
         return;
     }
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    if (screen != Screen::Playing || viewer)
         return;
 
-    QTextStream in(&file);
-    playerName = in.readLine().trimmed();
-    highScore = in.readLine().toInt();
-    file.close();
+    switch (event->key()) {
+    case Qt::Key_Backspace: rewindGame(120); return;    // 1 s
+    case Qt::Key_F5: quickSave(); return;
+    case Qt::Key_F9: quickLoad(); return;
+    default: break;
+    }
 
-    if (playerName.isEmpty())
-        playerName = "Player";
+    pushKeyEdge(event->key(), true);
 }
 
-
-void MainWindow::saveHighScore()
+void MainWindow::keyReleaseEvent(QKeyEvent *event)
 {
-    QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-
-    QDir().mkpath(dirPath);
-
-    QString filePath = dirPath + "/player_info.txt";
-    QFile file(filePath);
-
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qDebug() << "FAILED TO CREATE FILE:" << filePath;
+    if (event->isAutoRepeat())
+        return;
+    if (screen != Screen::Playing)
         return;
-    }
-
-    QTextStream out(&file);
-    // qDebug() << playerName << " " << highScore;
-
-    out << playerName << "\n" << highScore;
-    file.close();
 
-    qDebug() << "Saved highscore to:" << filePath;
+    pushKeyEdge(event->key(), false);
 }
 
+void MainWindow::pushKeyEdge(int key, bool pressed)
+{
+    // Stamped now; applied by the physics step at this time
+    qint64 now = inputClock.nsecsElapsed();
+    if (key == Qt::Key_A || key == Qt::Key_Left)
+        inputQueue.push({ now, InputSource::Keyboard, InputAction::Left, pressed });
+    else if (key == Qt::Key_D || key == Qt::Key_Right)
+        inputQueue.push({ now, InputSource::Keyboard, InputAction::Right, pressed });
+}
 
+/* -------------------------------------------------------------
+   REWIND / SAVE STATES: the held keys stay as they are, only
+   the game goes back
+--------------------------------------------------------------*/
+void MainWindow::rewindGame(int steps)
+{
+    // Would leave the other players behind
+    if (versus || !rewindBuffer.rewind(steps, sim))
+        return;
+    ranked = false;
+    accumulator = 0.0f;
+    frameClock.restart();
+}
 
+static QString quickSavePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/quicksave.eggs";
+}
 
-// ======================================================
-// INPUT HANDLING
-// ======================================================
-
-void MainWindow::keyPressEvent(QKeyEvent *event)
+void MainWindow::quickSave()
 {
-    if (event->isAutoRepeat())
-        return;
+    QFile file(quickSavePath());
+    if (!file.open(QIODevice::WriteOnly) || file.write(SimSnapshot::save(sim)) < 0)
+        qDebug() << "FAILED TO WRITE SAVE STATE:" << file.fileName();
+}
 
-    if (gameOver && event->key() == Qt::Key_R) {
-        // If game over, and R is pressed, reset the game
-        resetGame();
+void MainWindow::quickLoad()
+{
+    if (versus)
         return;
-    }else if(gameOver && event->key() == Qt::Key_M){
-        gameRunning = false;
-        showMenu = true;
-        // Ensure buttons are shown on the next gameTick
-        nameInput->show();
-        playButton->show();
-        leaderboardButton->show();
-        backToMenuButton->hide();
+    QFile file(quickSavePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "NO SAVE STATE:" << file.fileName();
         return;
     }
-
-    if (!gameRunning || gameOver)
+    if (!SimSnapshot::load(sim, file.readAll()))
         return;
-
-    if (event->key() == Qt::Key_A || event->key() == Qt::Key_Left)
-        moveLeft = true;
-    else if (event->key() == Qt::Key_D || event->key() == Qt::Key_Right)
-        moveRight = true;
+    // The history belongs to the game that was just replaced
+    rewindBuffer.clear();
+    ranked = false;
+    accumulator = 0.0f;
+    frameClock.restart();
 }
 
-void MainWindow::keyReleaseEvent(QKeyEvent *event)
+/* -------------------------------------------------------------
+   VERSUS: EGGCATCHER_VERSUS holds the players (see NetSession::
+   parseSpec), EGGCATCHER_NET_LOSS / EGGCATCHER_NET_LATENCY fake
+   a bad network for testing on one machine
+--------------------------------------------------------------*/
+void MainWindow::startVersus()
 {
-    if (event->isAutoRepeat())
+    versus.reset();
+    const QString spec = qEnvironmentVariable("EGGCATCHER_VERSUS");
+    if (spec.isEmpty())
         return;
-    if (gameOver || !gameRunning)
+
+    NetSession::Config config;
+    if (!NetSession::parseSpec(spec, config)) {
+        qDebug() << "VERSUS: cannot read EGGCATCHER_VERSUS" << spec;
         return;
+    }
+    if (qEnvironmentVariableIsSet("EGGCATCHER_VERSUS_SEED"))
+        config.seed = quint32(qEnvironmentVariableIntValue("EGGCATCHER_VERSUS_SEED"));
+    config.lossPercent = qEnvironmentVariableIntValue("EGGCATCHER_NET_LOSS");
+    config.latencyMs = qEnvironmentVariableIntValue("EGGCATCHER_NET_LATENCY");
 
-    if (event->key() == Qt::Key_A || event->key() == Qt::Key_Left)
-        moveLeft = false;
-    else if (event->key() == Qt::Key_D || event->key() == Qt::Key_Right)
-        moveRight = false;
+    versus = std::make_unique<NetSession>(sim, config, this);
+    if (!versus->isOpen())
+        versus.reset();
+    versusSteer.reset();
+}
+
+// Input up to the end of this step, kept for the network
+// instead of steering the basket directly
+void MainWindow::sampleVersusInput()
+{
+    InputEvent event;
+    while (inputQueue.takeUntil(stepEndNs, event))
+        versusSteer.apply(event);
+
+    const PointerSample &pointer = ui->frame->pointerSample();
+    if (pointer.seq != pointerSeq && pointer.timeNs <= stepEndNs) {
+        if (pointer.active)
+            versusSteer.setPointer(pointer.pos.x() / canvasScale / grid_box);
+        else
+            versusSteer.releasePointer();
+        pointerSeq = pointer.seq;
+    }
 }
 
 // ======================================================
@@ -417,74 +347,197 @@ void MainWindow::startGameButtonClicked() {
     ? "Player"
     : nameInput->text().trimmed();
 
-    showMenu = false;
-    gameRunning = true;
     resetGame();
 }
 
 
 void MainWindow::showLeaderboardButtonClicked() {
+    loadingLeaderboard = true;
+    setScreen(Screen::Leaderboard);
+    reloadLeaderboard();
+}
 
-    showMenu = false;
-    nameInput->hide();
-    playButton->hide();
-    leaderboardButton->hide();
-    showLeaderboard = true;
+void MainWindow::reloadLeaderboard()
+{
     loadingLeaderboard = true;
+    aroundMeButton->setText(leaderboardAroundMe ? "TOP 5" : "AROUND ME");
 
     QTimer::singleShot(10, this, [this]() {
-        leaderboardManager.loadScores();
+        leaderboardRows = leaderboardAroundMe
+                              ? leaderboardManager.loadAround(deviceID, kAroundMeRows)
+                              : leaderboardManager.loadScores();
         loadingLeaderboard = false;
+        requestFrame();
     });
+    requestFrame();   // spinner animates until the rows land
+}
+
+// Simulation events become log records and sounds
+void MainWindow::onGameEvent(GameEventKind kind, EggType type, float value, float x)
+{
+    sessionLog.log(kind, sessionTime(), sim.score, quint8(type), value);
+
+    float pan = x / sim.cols * 2.0f - 1.0f;
+    if (kind == GameEventKind::Catch)
+        audio.play(Sfx::Catch, 0.8f, pan);
+    else if (kind == GameEventKind::Splat)
+        audio.play(Sfx::Splat, 0.9f, pan);
+    else if (kind == GameEventKind::WindStart)
+        audio.play(Sfx::Wind, 0.6f, value < 0.0f ? -0.5f : 0.5f);
 }
 
 void MainWindow::handleGameOver()
 {
-    highScore = std::max(score, highScore);
+    if (gameOverHandled)
+        return;
+    gameOverHandled = true;
+
+    if (!autoplay)
+        profileStore.addSession(sim.score, int(sessionClock.elapsed()));
+    sessionLog.end();
+    // EGGCATCHER_INPUT_LATENCY: report how long input took to reach the basket
+    if (qEnvironmentVariableIsSet("EGGCATCHER_INPUT_LATENCY"))
+        qDebug().noquote() << "INPUT LATENCY (event -> basket velocity)\n" + inputLatency.summary();
+
+    if (!ranked) {
+        // Played by the bot, rewound or loaded: the score and any high
+        // score it reached (a save state carries its own) stay off the
+        // profile and board
+        sim.highScore = profileStore.profile().highScore;
+        profileStore.setName(playerName);
+        profileStore.save();
+        return;
+    }
 
+    // A versus game counts its high score from 0
+    sim.highScore = std::max({ sim.score, sim.highScore, profileStore.profile().highScore });
     saveHighScore();
-    if (score >= 0) {
-        QString deviceID = getDeviceID();
-        qDebug() << playerName << " " << highScore;
-        leaderboardManager.addScore(deviceID, playerName, highScore);
+    if (sim.score >= 0) {
+        qDebug() << playerName << " " << sim.highScore;
+        leaderboardManager.addScore(deviceID, playerName, sim.highScore);
     }
 }
 
 void MainWindow::resetGame()
 {
-    ui->scoreLabel->show();
-    ui->livesLabel->show();
-    score = 0;
-    lives = 3;
-    eggs.clear();
-    basket = QPointF(cols / 2.0f, rows - 3.0f);
-    prevBasketX = basket.x();
-    basketXVelocity = 0.0f;
-    basketTargetVel = 0.0f;
-    gameOver = false;
-    moveRight = false;
-    moveLeft = false;
+    sim.reset(QRandomGenerator::global()->generate());
+    sim.highScore = profileStore.profile().highScore;   // after a versus game it was the match's
+    startVersus();
+    rewindBuffer.clear();
+    gameOverHandled = false;
+    ranked = !autoplay;
+    sessionClock.start();
+    sessionLog.begin(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                     + "/sessions/"
+                     + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss-zzz")
+                     + ".egglog");
+    inputQueue.clear();
+    pointerSeq = ui->frame->pointerSample().seq;   // ignore moves made in the menu
+    inputLatency.clear();
     accumulator = 0.0f;
-    flashColor = QColor();
     frameClock.restart();
-    gameRunning = true;
-    showMenu = false;
-    showLeaderboard = false;
 
-    // Hide Menu UI
-    nameInput->hide();
-    playButton->hide();
-    leaderboardButton->hide();
-    backToMenuButton->hide();
+    setScreen(Screen::Playing);
+}
 
-    gameTimer->start();
+/* -------------------------------------------------------------
+   SCREENS: widgets change and the timer starts/stops only on a
+   transition. Menu, game over and the loaded leaderboard are
+   drawn once and then left alone; gameTick keeps running only
+   for gameplay and the leaderboard spinner.
+--------------------------------------------------------------*/
+void MainWindow::setScreen(Screen next)
+{
+    screen = next;
+    const bool menu = next == Screen::Menu;
+    const bool board = next == Screen::Leaderboard;
+    const bool playing = next == Screen::Playing;
+
+    nameInput->setVisible(menu);
+    playButton->setVisible(menu);
+    leaderboardButton->setVisible(menu);
+    backToMenuButton->setVisible(board);
+    aroundMeButton->setVisible(board);
+    ui->scoreLabel->setVisible(playing);
+    ui->livesLabel->setVisible(playing);
+
+    if (menu) {
+        menuWallClock.start();
+        menuCpuStartMs = processCpuMs();
+        menuFrames = 0;
+    }
+    if (menu)
+        versus.reset();
+
+    // The new screen draws on its first tick, which also decides whether to keep ticking
+    gameTimer->stop();
+    requestFrame();
+
+    // Only ever reached from gameTick after its step loop, with the
+    // timer stopped: the leaderboard submit spins an event loop, and
+    // no tick may run a step under it
+    if (next == Screen::GameOver)
+        handleGameOver();
+}
 
-    // Reset wind and focus mode
-    windActive = false;
-    windStrength = 0.0f;
-    windTimer = 0.0f;
-    timeSinceLastWind = 0.0f;
-    focusMode = false;
+bool MainWindow::screenAnimates() const
+{
+    return screen == Screen::Playing
+           || (screen == Screen::Leaderboard && loadingLeaderboard);
+}
+
+void MainWindow::requestFrame()
+{
+    // A running timer draws anyway; otherwise post one redraw, coalesced
+    if (gameTimer->isActive() || framePending)
+        return;
+    framePending = true;
+    QTimer::singleShot(0, this, &MainWindow::gameTick);
+}
+
+void MainWindow::logMenuIdle()
+{
+    qint64 wallMs = menuWallClock.elapsed();
+    qint64 cpuMs = processCpuMs() - menuCpuStartMs;
+    qDebug().nospace() << "MENU IDLE: " << cpuMs << " ms CPU over " << wallMs << " ms ("
+                       << (wallMs > 0 ? 100.0 * cpuMs / wallMs : 0.0) << "% of a core), "
+                       << menuFrames << " frames drawn";
+}
+
+/* -------------------------------------------------------------
+   STARTUP: only what the first menu frame needs runs before it.
+   Sounds (decoded from the bundled resources on a pool thread),
+   the audio device and the leaderboard connection come after.
+--------------------------------------------------------------*/
+void MainWindow::setLaunchClock(const QElapsedTimer &clock)
+{
+    launchClock = clock;
+}
+
+void MainWindow::loadDeferredAssets()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    auto *watcher = new QFutureWatcher<QVector<AudioClip>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, timer]() {
+        QVector<AudioClip> clips = watcher->result();
+        for (int i = 0; i < clips.size(); ++i)
+            audio.install(Sfx(i), std::move(clips[i]));
+        audio.start();
+        if (qEnvironmentVariableIsSet("EGGCATCHER_STARTUP_PROBE"))
+            qDebug() << "DEFERRED ASSETS READY after" << timer.elapsed() << "ms";
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([]() {
+        static const char *paths[] = { ":/sfx/catch.wav", ":/sfx/lose.wav", ":/sfx/wind.wav" };
+        QVector<AudioClip> clips(int(Sfx::Count));
+        for (int i = 0; i < int(Sfx::Count); ++i)
+            AudioEngine::decodeResource(paths[i], clips[i]);
+        return clips;
+    }));
+
+    leaderboardManager.warmUp();
 }
 
 // ======================================================
@@ -493,13 +546,14 @@ void MainWindow::resetGame()
 
 void MainWindow::drawMenu()
 {
-    QPixmap pix = background;
+    QPixmap pix = screenCanvas();
     QPainter p(&pix);
+    p.scale(canvasScale, canvasScale);
     p.setRenderHint(QPainter::Antialiasing, true);
 
     p.setPen(Qt::yellow);
     p.setFont(QFont("Comic Sans MS", 36, QFont::Bold));
-    p.drawText(pix.rect().adjusted(0, -400, 0, 0), Qt::AlignCenter,
+    p.drawText(canvasRect().adjusted(0, -400, 0, 0), Qt::AlignCenter,
                "EGG CATCHER");
 
     p.setPen(Qt::white);
@@ -510,46 +564,59 @@ void MainWindow::drawMenu()
     p.end();
     ui->frame->setPixmap(pix);
 
-    // Show/Hide UI elements
-    nameInput->show();
-    playButton->show();
-    leaderboardButton->show();
-    backToMenuButton->hide();
-    ui->scoreLabel->hide();
-    ui->livesLabel->hide();
+    ++menuFrames;
+    if (!firstMenuFrameShown) {
+        firstMenuFrameShown = true;
+        QTimer::singleShot(0, this, &MainWindow::loadDeferredAssets);
+
+        // EGGCATCHER_STARTUP_PROBE: log the cold start and quit
+        if (qEnvironmentVariableIsSet("EGGCATCHER_STARTUP_PROBE")) {
+            qDebug() << "COLD START: first menu frame after" << launchClock.elapsed() << "ms";
+            QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+        }
 
-    // Save current name
-    playerName = nameInput->text().trimmed().isEmpty() ? "Player" : nameInput->text().trimmed();
+        // EGGCATCHER_IDLE_PROBE=<seconds>: sit on the menu, log its cost, quit
+        int idleProbe = qEnvironmentVariableIntValue("EGGCATCHER_IDLE_PROBE");
+        if (idleProbe > 0) {
+            QTimer::singleShot(idleProbe * 1000, this, [this]() {
+                logMenuIdle();
+                QCoreApplication::quit();
+            });
+        }
+    }
 }
 
 void MainWindow::drawGameOver()
 {
-    ui->scoreLabel->hide();
-    ui->livesLabel->hide();
-    QPixmap pix = background;
+    QPixmap pix = screenCanvas();
     QPainter p(&pix);
+    p.scale(canvasScale, canvasScale);
     p.setRenderHint(QPainter::Antialiasing, true);
 
     p.setPen(Qt::red);
     p.setFont(QFont("Arial", 28, QFont::Bold));
-    p.drawText(pix.rect(), Qt::AlignCenter,
-               "GAME OVER\n\nScore: " + QString::number(score) + "\n\nPress R to Restart and M to go back to Menu");
+    QString place;
+    if (versus) {
+        int ahead = 0;
+        for (int i = 0; i < versus->players(); ++i)
+            ahead += versus->player(i).score > sim.score;
+        place = QString("\nPlace: %1 of %2").arg(ahead + 1).arg(versus->players());
+    }
+    if (!ranked)
+        place += autoplay ? "\n(bot game: not ranked)" : "\n(rewound or loaded: not ranked)";
+    p.drawText(canvasRect(), Qt::AlignCenter,
+               "GAME OVER\n\nScore: " + QString::number(sim.score) + place + "\n\nPress R to Restart and M to go back to Menu");
 
     p.end();
     ui->frame->setPixmap(pix);
-
-    // Hide all menu/leaderboard buttons when game over is displayed
-    nameInput->hide();
-    playButton->hide();
-    leaderboardButton->hide();
-    backToMenuButton->hide();
 }
 
 
 void MainWindow::drawLeaderboard()
 {
-    QPixmap pix = background;
+    QPixmap pix = screenCanvas();
     QPainter p(&pix);
+    p.scale(canvasScale, canvasScale);
     p.setRenderHint(QPainter::Antialiasing, true);
 
     /* --------------------------------------------------------
@@ -558,14 +625,14 @@ void MainWindow::drawLeaderboard()
     if (loadingLeaderboard) {
 
         // dim overlay
-        p.fillRect(pix.rect(), QColor(0, 0, 0, 150));
+        p.fillRect(canvasRect(), QColor(0, 0, 0, 150));
 
         // spinner graphics
         p.setRenderHint(QPainter::Antialiasing, true);
         p.setPen(QPen(Qt::yellow, 6, Qt::SolidLine, Qt::RoundCap));
 
-        int cx = pix.width() / 2;
-        int cy = pix.height() / 2;
+        int cx = grid_size / 2;
+        int cy = grid_size / 2;
         int r  = 40;
 
         // draw rotating arc
@@ -582,7 +649,7 @@ void MainWindow::drawLeaderboard()
         // text: "Loading Leaderboard..."
         p.setPen(Qt::white);
         p.setFont(QFont("Arial", 20, QFont::Bold));
-        p.drawText(0, cy + 80, pix.width(), 40,
+        p.drawText(0, cy + 80, grid_size, 40,
                    Qt::AlignCenter, "Loading Leaderboard...");
 
         p.end();
@@ -594,12 +661,12 @@ void MainWindow::drawLeaderboard()
        LOADING FINISHED → DRAW FULL LEADERBOARD
     --------------------------------------------------------*/
 
-    QVector<ScoreEntry> topScores = leaderboardManager.loadScores();
+    const QVector<ScoreEntry> &rows = leaderboardRows;
 
     p.setPen(Qt::cyan);
     p.setFont(QFont("Comic Sans MS", 30, QFont::Bold));
-    p.drawText(pix.rect().adjusted(0, -500, 0, 0), Qt::AlignCenter,
-               "TOP EGG CATCHERS");
+    p.drawText(canvasRect().adjusted(0, -500, 0, 0), Qt::AlignCenter,
+               leaderboardAroundMe ? "AROUND YOU" : "TOP EGG CATCHERS");
 
     int yPos = 200;
     p.setFont(QFont("Arial", 20, QFont::Bold));
@@ -611,17 +678,31 @@ void MainWindow::drawLeaderboard()
     p.drawText(400, yPos, "NAME");
     yPos += 30;
 
+    int playerRow = -1;
+    if (leaderboardAroundMe) {
+        for (int i = 0; i < rows.size() && playerRow < 0; ++i)
+            if (rows[i].id == deviceID)
+                playerRow = i;
+    }
+
     for (int i = 0; i < 5; ++i) {
-        p.setPen(i == 0 ? Qt::yellow : Qt::white);
+        bool highlight = leaderboardAroundMe ? (i == playerRow) : (i == 0);
+        p.setPen(highlight ? Qt::yellow : Qt::white);
         p.setFont(QFont("Arial", 18));
 
         QString rank = QString::number(i + 1);
         QString scoreText = "---";
         QString nameText = "Empty";
 
-        if (i < topScores.size()) {
-            scoreText = QString::number(topScores[i].score);
-            nameText = topScores[i].name;
+        if (i < rows.size()) {
+            if (rows[i].rank > 0)
+                rank = QString::number(rows[i].rank);
+            else if (leaderboardAroundMe)
+                rank = "-";     // rank not known (see RestLeaderboardBackend::rankForScore)
+            scoreText = QString::number(rows[i].score);
+            nameText = rows[i].name;
+        } else if (leaderboardAroundMe) {
+            rank = scoreText = nameText = "";
         }
 
         p.drawText(150, yPos, rank);
@@ -630,6 +711,16 @@ void MainWindow::drawLeaderboard()
         yPos += 40;
     }
 
+    if (leaderboardAroundMe) {
+        p.setPen(Qt::white);
+        p.setFont(QFont("Arial", 18));
+        QString line = "Play a game to get ranked";
+        if (playerRow >= 0)
+            line = rows[playerRow].rank > 0 ? QString("Your rank: #%1").arg(rows[playerRow].rank)
+                                            : QString("Your rank: not known yet");
+        p.drawText(0, yPos + 10, grid_size, 30, Qt::AlignCenter, line);
+    }
+
     p.end();
     ui->frame->setPixmap(pix);
 
@@ -637,6 +728,7 @@ void MainWindow::drawLeaderboard()
     playButton->hide();
     leaderboardButton->hide();
     backToMenuButton->show();
+    aroundMeButton->show();
     ui->scoreLabel->hide();
     ui->livesLabel->hide();
 }
@@ -648,43 +740,76 @@ void MainWindow::drawLeaderboard()
 
 void MainWindow::gameTick()
 {
-    // State machine for screens
-    if (showMenu) {
-        drawMenu();
-        return;
-    }
-    if (showLeaderboard) {
-        drawLeaderboard();
+    framePending = false;
+
+    // Moved to a screen with another scale factor
+    if (ui->frame->devicePixelRatioF() != canvasDpr)
+        layoutCanvas();
+
+    // Static screens draw and stop; only the spinner keeps the timer going
+    if (screen != Screen::Playing) {
+        if (screen == Screen::Menu)
+            drawMenu();
+        else if (screen == Screen::Leaderboard)
+            drawLeaderboard();
+        else
+            drawGameOver();
+
+        if (!screenAnimates())
+            gameTimer->stop();
+        else if (!gameTimer->isActive())
+            gameTimer->start();
         return;
     }
+    if (!gameTimer->isActive())
+        gameTimer->start();
 
-    if (gameOver) {
-        handleGameOver(); // Handle score submission when game over is first hit
-        drawGameOver();
+    if (viewer) {
+        // Watching: the publisher runs the game, this only draws it
+        viewer->update(sim);
+        drawGame(1.0f);
         return;
     }
 
-
     // Elapsed real time
     float dt = frameClock.restart() / 1000.0f;
     dt = qBound(0.001f, dt, 0.05f);   // clamp: min 1ms, max 50ms
     accumulator += dt;
 
-    // Run physics in fixed steps
-    const float fixedStep = fixedDelta;  // 1/120 s
-    while (accumulator >= fixedStep) {
-        updatePhysics(fixedStep);
+    gamepad->poll();
+    qint64 nowNs = inputClock.nsecsElapsed();
+
+    // Run physics in fixed steps; each step ends `accumulator` before now
+    const float fixedStep = sim.fixedDelta;  // 1/120 s
+    auto over = [this]() { return versus ? versus->allOver() : sim.isOver(); };
+    while (accumulator >= fixedStep && !over()) {
+        stepEndNs = nowNs - qint64((accumulator - fixedStep) * 1e9);
+        if (versus) {
+            sampleVersusInput();
+            if (!versus->advance(NetInput::fromSteer(versusSteer))) {
+                // Waiting on a peer; do not bank the time
+                accumulator = 0.0f;
+                break;
+            }
+        } else {
+            sim.step(fixedStep);
+            rewindBuffer.push(sim);
+        }
         accumulator -= fixedStep;
     }
+    if (broadcast)
+        broadcast->publish(sim);
+    if (over()) {
+        setScreen(Screen::GameOver);   // posts the game over frame
+        return;
+    }
 
     float alpha = accumulator / fixedStep;
 
     drawGame(alpha);
 
-    const int targetFrameMS = 16; // ~60fps
-    int elapsed = frameClock.elapsed();
-    if (elapsed < targetFrameMS)
-        QThread::msleep(targetFrameMS - elapsed);
+    // No sleep here: gameTimer already paces frames, and blocking the
+    // UI thread would hold back the next key event by up to a frame.
 
     static int frameCount = 0;
     static float fpsTimer = 0;
@@ -695,434 +820,157 @@ void MainWindow::gameTick()
         frameCount = 0;
         fpsTimer = 0;
     }
-
-    if (scoreAnimTimer > 0.0f) {
-        scoreAnimTimer -= dt;
-        float t = 1.0f - scoreAnimTimer / 0.2f;
-        scoreScale = 1.0f + 0.5f * (1.0f - t * t); // ease-out
-    } else {
-        scoreScale = 1.0f;
-        scoreChanged = false;
-    }
-
-    // Lives pulse animation decay
-    if (livesPulseTimer > 0.0f) {
-        livesPulseTimer -= dt;
-    }
 }
 
 // ======================================================
-// PHYSICS UPDATE
+// PHYSICS INPUT (GameSimulation::step calls stepBasket)
 // ======================================================
 
-void MainWindow::updatePhysics(float dt)
+/* -------------------------------------------------------------
+   BASKET: queued input edges split the step at their timestamps,
+   the basket integrates each piece with the input held then.
+   Mouse/touch is absolute: only the newest pointer sample is
+   read, once per step, however many moves arrived since.
+--------------------------------------------------------------*/
+void MainWindow::stepBasket(float dt)
 {
-    if (gameOver)
-        return;
-
-    globalTime += dt;
-    globalSpawnTimer += dt;
+    const qint64 stepStart = stepEndNs - qint64(dt * 1e9);
+    qint64 t = stepStart;
 
-    // ---------- FOCUS MODE STATE (cyclic based on score) ----------
-    bool newFocus = false;
-    if (score >= 50) {
-        int t = score - 50;
-        int m = t % 150;
-        if (m < 100)
-            newFocus = true;
-    }
-    focusMode = newFocus;
-
-    // ---------- WIND STATE UPDATE ----------
-    timeSinceLastWind += dt;
-
-    if (!windActive && timeSinceLastWind >= windCooldown) {
-        if (QRandomGenerator::global()->bounded(1000) < 2) {
-            windActive = true;
-            windTimer = QRandomGenerator::global()->bounded(1200, 2500) / 1000.0f;
-            timeSinceLastWind = 0.0f;
-
-            float minStrength = 2.0f;
-            float maxStrength = 6.0f;
-
-            if (focusMode) {
-                minStrength = 4.0f;
-                maxStrength = 10.0f;
-            }
-
-            float magnitude = QRandomGenerator::global()->bounded(
-                                  (int)(minStrength * 100),
-                                  (int)(maxStrength * 100)
-                                  ) / 100.0f;
-            int direction = (QRandomGenerator::global()->bounded(0, 2) == 0) ? -1 : 1;
-            windStrength = direction * magnitude;
-        }
-    }
-
-    if (windActive) {
-        windTimer -= dt;
-        if (windTimer <= 0.0f) {
-            windActive = false;
-            windStrength = 0.0f;
-        }
-    }
-
-    // -----------------------------------------------------------
-    //              WIND DUST PARTICLE SPAWNING
-    // -----------------------------------------------------------
-    if (windActive && std::abs(windStrength) > 0.05f) {
-        int count = 8;  // good balance, you can increase to 12 if needed
-
-        for (int i = 0; i < count; i++) {
-            WindParticle wp;
-
-            wp.pos = QPointF(
-                QRandomGenerator::global()->bounded(cols),
-                QRandomGenerator::global()->bounded(int(rows * 0.7f))
-                );
-
-            float dir = (windStrength > 0.0f) ? 1.0f : -1.0f;
-
-            wp.vel = QPointF(
-                dir * (0.4f + QRandomGenerator::global()->bounded(120) / 100.0f),
-                (QRandomGenerator::global()->bounded(-20, 21) / 100.0f)
-                );
+    auto advanceTo = [&](qint64 at) {
+        at = qMax(at, stepStart);
+        sim.integrateBasket((at - t) / 1e9f);
+        t = at;
+    };
 
-            wp.maxLife = 0.6f + (QRandomGenerator::global()->bounded(40) / 100.0f);
-            wp.lifetime = wp.maxLife;
-            wp.alpha = 1.0f;
+    const PointerSample &pointer = ui->frame->pointerSample();
+    bool pointerPending = pointer.seq != pointerSeq && pointer.timeNs <= stepEndNs;
+    auto applyPointer = [&]() {
+        advanceTo(pointer.timeNs);
+        if (pointer.active)
+            sim.steer.setPointer(pointer.pos.x() / canvasScale / grid_box);
+        else
+            sim.steer.releasePointer();
+        inputLatency.add(InputSource::Mouse, inputClock.nsecsElapsed() - pointer.timeNs);
+        pointerSeq = pointer.seq;
+        pointerPending = false;
+    };
 
-            windParticles.push_back(wp);
-        }
-    }
+    InputEvent event;
+    while (inputQueue.takeUntil(stepEndNs, event)) {
+        if (pointerPending && pointer.timeNs <= event.timeNs)
+            applyPointer();
+        advanceTo(event.timeNs);
 
-    // -----------------------------------------------------------
-    //              WIND DUST PARTICLE UPDATE
-    // -----------------------------------------------------------
-    QVector<WindParticle> wpSurvivors;
-    for (auto &wp : windParticles) {
-        wp.pos += wp.vel * (dt * 60.0f);
-        wp.lifetime -= dt;
-        wp.alpha = qMax(0.0f, wp.lifetime / wp.maxLife);
-
-        if (wp.lifetime > 0)
-            wpSurvivors.push_back(wp);
-    }
-    windParticles = wpSurvivors;
-
-    // -----------------------------------------------------------
-    //              WIND STREAK SPAWNING (>>>> / <<<<)
-    // -----------------------------------------------------------
-    if (windActive && std::abs(windStrength) > 0.05f) {
-        // Random chance per physics tick to avoid too many streaks
-        if (QRandomGenerator::global()->bounded(100) < 30) {
-            WindStreak ws;
-
-            ws.pos = QPointF(
-                QRandomGenerator::global()->bounded(cols),
-                QRandomGenerator::global()->bounded(rows)
-                );
-
-            ws.maxLife = 0.8f;
-            ws.lifetime = ws.maxLife;
-            ws.alpha = 1.0f;
-
-            windStreaks.push_back(ws);
-        }
+        float before = sim.steer.targetVelocity(sim.basket.x(), sim.basketMaxVel);
+        sim.steer.apply(event);
+        if (sim.steer.targetVelocity(sim.basket.x(), sim.basketMaxVel) != before)
+            inputLatency.add(event.source, inputClock.nsecsElapsed() - event.timeNs);
     }
+    if (pointerPending)
+        applyPointer();
 
-    // -----------------------------------------------------------
-    //              WIND STREAK UPDATE
-    // -----------------------------------------------------------
-    QVector<WindStreak> streakAlive;
-    for (auto &ws : windStreaks) {
-        ws.lifetime -= dt;
-        ws.alpha = qMax(0.0f, ws.lifetime / ws.maxLife);
-        if (ws.lifetime > 0)
-            streakAlive.push_back(ws);
-    }
-    windStreaks = streakAlive;
-
-    // -------------------- EGG SPAWN --------------------
-    if (globalSpawnTimer >= spawnInterval) {
-        int col = dropColumns[currentColumnIndex];
-        bool isEdgeCol = (col == dropColumns.front() || col == dropColumns.back());
-        bool canSpawn = true;
-
-        float dynamicEdgeCooldown = qMax(0.6f, edgeSpawnCooldown - 0.03f * score);
-        if (isEdgeCol && (globalTime - lastEdgeSpawnTime < dynamicEdgeCooldown))
-            canSpawn = false;
-
-        if (canSpawn) {
-            Egg e;
-            e.pos = QPointF(float(col), 0.0f);
-            e.yVelocity = 0.0f;
-            e.state = "falling";
-
-            int r = QRandomGenerator::global()->bounded(100);
-            if (r < 75) {
-                e.type = "normal";
-                e.color = QColor(Qt::white);
-            } else if (r < 95) {
-                e.type = "bad";
-                e.color = QColor(200, 50, 50);
-            } else {
-                e.type = "life";
-                e.color = QColor(255, 105, 180);
-            }
+    sim.integrateBasket((stepEndNs - t) / 1e9f);
+}
 
-            eggs.append(e);
-            if (isEdgeCol)
-                lastEdgeSpawnTime = globalTime;
-        }
+// ======================================================
+// RENDER CACHE
+// ======================================================
 
-        currentColumnIndex = (currentColumnIndex + 1) % dropColumns.size();
-        globalSpawnTimer = 0.0f;
-        spawnInterval = 0.8f + QRandomGenerator::global()->bounded(0.6f);
+void MainWindow::rebuildRenderCache()
+{
+    const int physical = qCeil(canvasSide * canvasDpr);
+    for (QPixmap &buf : frameBuffers) {
+        buf = QPixmap(physical, physical);
+        buf.setDevicePixelRatio(canvasDpr);
     }
+    frameIndex = 0;
 
-    // -------------------- BASKET MOVEMENT --------------------
-    if (moveLeft && !moveRight)
-        basketTargetVel = -basketMaxVel;
-    else if (moveRight && !moveLeft)
-        basketTargetVel = basketMaxVel;
-    else
-        basketTargetVel = 0.0f;
-
-    float blend = 1.0f - qExp(-basketAccel * dt);
-    Q_UNUSED(blend);
-
-    basketXVelocity += (basketTargetVel - basketXVelocity) * qMin(1.0f, dt * basketAccel);
+    renderer.setCanvas(canvasSide, canvasDpr);
+}
 
-    basket.setX(basket.x() + basketXVelocity * dt);
-    basket.setX(std::clamp((float)basket.x(), 0.0f, float(cols - 1)));
-    prevBasketX = basket.x();
 
-    // -------------------- EGG PHYSICS & DIFFICULTY --------------------
-    float baseGravity = 10.0f + score * 0.05f;
-    float maxFallSpeed = 22.0f;
+/* -------------------------------------------------------------
+   SIZE / DPR
+   The frame follows the window as a square; everything is still
+   drawn in grid_size logical units through canvasScale. Targets
+   are reallocated at once, backgrounds and sprites for a new size
+   come from AssetCache (worker thread), and until they land the
+   nearest older set is drawn scaled, so a resize never blocks.
+--------------------------------------------------------------*/
+void MainWindow::resizeEvent(QResizeEvent *event)
+{
+    QMainWindow::resizeEvent(event);
+    layoutCanvas();
+    requestFrame();
+}
 
-    spawnInterval = qMax(0.6f, 1.0f - score * 0.01f);
+void MainWindow::showEvent(QShowEvent *event)
+{
+    QMainWindow::showEvent(event);
 
-    if (focusMode) {
-        baseGravity *= 1.15f;
-        maxFallSpeed *= 1.15f;
-        spawnInterval = qMax(0.5f, spawnInterval - 0.05f);
+    // With the timer stopped nothing else notices a DPR change
+    if (!screenWatched && windowHandle()) {
+        screenWatched = true;
+        connect(windowHandle(), &QWindow::screenChanged, this, [this]() {
+            layoutCanvas();
+            requestFrame();
+        });
     }
+}
 
-    QVector<Egg> survivors;
-    bool caughtAny = false;
-    bool lostAny = false;
-    bool lostLifeAny = false;
-    bool gainedLifeAny = false;
-
-    for (auto &egg : eggs) {
-        egg.prevY = egg.pos.y();
-        float gravity = baseGravity;
-        if (egg.type == "life") gravity *= 0.5f;
-        if (egg.type == "bad")  gravity *= 1.2f;
-
-        if (egg.state == "falling") {
-            egg.yVelocity += gravity * dt;
-            egg.yVelocity = qMin(egg.yVelocity, maxFallSpeed);
-            egg.pos.setY(egg.pos.y() + egg.yVelocity * dt);
-
-            if (windActive) {
-                egg.pos.setX(egg.pos.x() + windStrength * dt);
-                egg.pos.setX(std::clamp((float)egg.pos.x(), 0.0f, float(cols - 1)));
-            }
-
-            int basketWidth = 16;
-            int basketHeight = 6;
-
-            QRectF basketRect(
-                basket.x() - basketWidth / 2.0f,
-                basket.y() - 0.5f,
-                basketWidth,
-                basketHeight + 1.5f
-                );
-
-            QRectF eggRect(egg.pos.x(), egg.pos.y(), 1.0f, 1.0f);
-
-            if (eggRect.intersects(basketRect)) {
-                egg.state = "caught";
-                egg.animTimer = 0;
-                caughtAny = true;
-
-                int scoreDelta = 0;
-
-                if (!focusMode) {
-                    if (egg.type == "normal" || egg.type == "life") scoreDelta = 2;
-                    else if (egg.type == "bad") scoreDelta = -2;
-                } else {
-                    if (egg.type == "normal" || egg.type == "life") scoreDelta = 5;
-                    else if (egg.type == "bad") scoreDelta = 0;
-                }
-
-                score += scoreDelta;
-
-                if (egg.type == "bad") {
-                    lives = std::max(0, lives - 1);
-                    lostLifeAny = true;
-                    flashColor = QColor(255, 0, 0);
-                    flashAlpha = 0.0f;
-                    flashTimer = 0.0f;
-                }
-                else if (egg.type == "life") {
-                    int oldLives = lives;
-                    lives = std::min(5, lives + 1);
-                    if (lives > oldLives) gainedLifeAny = true;
-                    flashColor = QColor(0, 255, 0);
-                    flashAlpha = 0.0f;
-                    flashTimer = 0.0f;
-                }
-            }
-            else if (egg.pos.y() >= rows - 1) {
-                egg.state = "splat";
-                egg.animTimer = 0;
-
-                if (egg.type != "bad") {
-                    lives = std::max(0, lives - 1);
-                    lostLifeAny = true;
-                }
-            }
+void MainWindow::layoutCanvas()
+{
+    QWidget *central = ui->centralwidget;
+    int side = qBound(ui->frame->minimumWidth(),
+                      qMin(central->width() - 40, central->height() - 50),
+                      ui->frame->maximumWidth());
 
-            survivors.push_back(egg);
-        }
-        else if (egg.state == "caught") {
-            egg.animTimer += dt;
-            egg.scale = 1.0f - egg.animTimer * 3.0f;
-            egg.alpha = 1.0f - egg.animTimer * 2.0f;
-            if (egg.animTimer < 0.5f)
-                survivors.push_back(egg);
-        }
-        else if (egg.state == "splat" && egg.animTimer < 1) {
-            int numParticles = 12;
-            int scale = 1000;
-            for (int i = 0; i < numParticles; ++i) {
-                int angleDeg = QRandomGenerator::global()->bounded(360);
-                double rad = angleDeg * M_PI / 180.0;
-
-                int speed = QRandomGenerator::global()->bounded(500, 1500);
-
-                Particle p;
-                p.pos = QPoint(int(egg.pos.x() * scale), int(egg.pos.y() * scale));
-                p.velocity = QPoint(int(cos(rad) * speed), int(sin(rad) * speed));
-                p.lifetime = QRandomGenerator::global()->bounded(30, 60);
-                p.alpha = 255;
-                p.color = egg.color;
-                particles.append(p);
-            }
-        }
-    }
+    ui->frame->setGeometry(20, 10, side, side);
+    ui->scoreLabel->move(ui->scoreLabel->x(), 10 + side + 10);
+    ui->livesLabel->move(ui->livesLabel->x(), 10 + side + 10);
 
-    eggs = survivors;
-    if (caughtAny) score++;
-    if (lostAny) lives--;
-    if (score > highScore) highScore = score;
-    if (lives <= 0) gameOver = true;
-
-    if (flashColor.isValid()) {
-        flashTimer += dt;
-        float fadeInDur = 0.2f;
-        float fadeOutDur = 0.5f;
-
-        if (flashTimer < fadeInDur)
-            flashAlpha = flashTimer / fadeInDur;
-        else if (flashTimer < fadeInDur + fadeOutDur)
-            flashAlpha = 1.0f - (flashTimer - fadeInDur) / fadeOutDur;
-        else {
-            flashColor = QColor();
-            flashAlpha = 0.0f;
-        }
+    canvasScale = qreal(side) / grid_size;
+    for (const auto &entry : logicalGeometry) {
+        const QRect &r = entry.second;
+        entry.first->setGeometry(QRectF(r.x() * canvasScale, r.y() * canvasScale,
+                                        r.width() * canvasScale, r.height() * canvasScale).toRect());
     }
 
-    if (caughtAny && !gameOver) {
-        scoreAnimTimer = 0.2f;
-        scoreScale = 1.5f;
-        scoreChanged = true;
-    }
+    qreal dpr = ui->frame->devicePixelRatioF();
+    if (side == canvasSide && dpr == canvasDpr)
+        return;
 
-    if ((lostLifeAny || gainedLifeAny) && !gameOver) {
-        livesPulseTimer = 0.3f;
-        livesChanged = true;
-    }
+    canvasSide = side;
+    canvasDpr = dpr;
+    rebuildRenderCache();
 
-    QVector<Particle> aliveParticles;
-    int scale = 1000;
-    for (auto &p : particles) {
-        p.pos += p.velocity / 60;
-        p.lifetime--;
-        p.alpha = std::max(0, (p.lifetime * 255) / 60);
-        if (p.lifetime > 0)
-            aliveParticles.push_back(p);
-    }
-    particles = aliveParticles;
+    if (auto assets = assetCache->request(canvasSide, canvasDpr))
+        applyRenderAssets(std::move(assets));
 }
 
-
-// ======================================================
-// EGG DRAWING UTILITY (Unchanged)
-// ======================================================
-
-void MainWindow::drawEggShape(QPainter &p, const Egg &egg, float cellSize)
+void MainWindow::applyRenderAssets(std::shared_ptr<const RenderAssets> assets)
 {
-    p.setRenderHint(QPainter::Antialiasing, false); // pixelated look
-
-    QPointF center((egg.pos.x() + 0.5f) * cellSize, (egg.pos.y() + 0.5f) * cellSize);
-
-    float baseW = cellSize * 2.5f * 1.5f; // width scaling
-    float baseH = cellSize * 2.5f * 2.0f; // height scaling
-    float w = baseW * egg.scale;
-    float h = baseH * egg.scale;
-
-    QColor fillColor = egg.color;
-    fillColor.setAlphaF(egg.alpha);
-    QColor outlineColor = Qt::yellow;
-    outlineColor.setAlphaF(egg.alpha);
-
-    int step = 1; // pixel step
-
-    // Lambda to draw a pixel
-    auto plot = [&](int gx, int gy) {
-        p.fillRect(center.x() + gx, center.y() + gy, step, step, fillColor);
-    };
-
-    for (int yi = -h / 2; yi <= h / 2; yi += step)
-    {
-        float yf = float(yi) / (h / 2);
-
-        float modifier = (yf < 0) ? (1.0f - 0.3f * yf * yf) : (1.0f + 0.1f * yf);
-
-        int xSpan = int((w / 2) * sqrt(1 - yf * yf) * modifier);
-
-        for (int xi = -xSpan; xi <= xSpan; xi += step)
-        {
-            plot(xi, yi);
-        }
-    }
-
-    p.setBrush(outlineColor);
-    for (int yi = -h / 2; yi <= h / 2; yi += step)
-    {
-        float yf = float(yi) / (h / 2);
-        float modifier = (yf < 0) ? (1.0f - 0.3f * yf * yf) : (1.0f + 0.1f * yf);
-        int xSpan = int((w / 2) * sqrt(1 - yf * yf) * modifier);
-
-        // left & right edges
-        p.fillRect(center.x() - xSpan, center.y() + yi, step, step, outlineColor);
-        p.fillRect(center.x() + xSpan, center.y() + yi, step, step, outlineColor);
-    }
+    renderer.setAssets(std::move(assets));
+}
 
-    if (egg.state == "splat")
-    {
-        int splatW = int(w);
-        int splatH = int(h * 0.4f);
-        QRectF splatRect(center.x() - splatW / 2, center.y() - splatH / 2, splatW, splatH);
-        p.fillRect(splatRect, fillColor);
-        p.setPen(QPen(outlineColor, 2.0));
-        p.drawRect(splatRect);
-    }
+QPixmap MainWindow::screenCanvas() const
+{
+    // The assets are built at the bucketed DPR, not the screen's own
+    const QPixmap &background = renderer.background();
+    const qreal bucket = AssetCache::dprBucket(canvasDpr);
+    const int bucketPhysical = qCeil(canvasSide * bucket);
+    if (background.devicePixelRatio() == bucket
+        && background.size() == QSize(bucketPhysical, bucketPhysical))
+        return background;
+
+    // Assets for this size are still being built
+    const int physical = qCeil(canvasSide * canvasDpr);
+    QPixmap pix(physical, physical);
+    pix.setDevicePixelRatio(canvasDpr);
+    QPainter p(&pix);
+    p.drawPixmap(QRect(0, 0, canvasSide, canvasSide), background);
+    return pix;
 }
 
 
@@ -1132,209 +980,27 @@ void MainWindow::drawEggShape(QPainter &p, const Egg &egg, float cellSize)
 
 void MainWindow::drawGame(float alpha)
 {
-    QPixmap framePix = background;
-
-    // In focus mode, darken the world
-    if (focusMode) {
-        framePix.fill(Qt::black);
-    }
+    // Reuse the buffer the label is not holding, so painting never detaches
+    QPixmap &framePix = frameBuffers[frameIndex];
+    frameIndex ^= 1;
 
     QPainter painter(&framePix);
-    painter.setRenderHint(QPainter::Antialiasing, true);
-
-    float basketRenderX = prevBasketX + (basket.x() - prevBasketX) * alpha;
-    float basketRenderY = basket.y();
-
-    int basketWidthCells = 16;
-    int basketHeightCells = 6;
-
-    QColor basketFill(205, 133, 63);
-    QColor basketOutline(120, 60, 20);
-
-    // -------- FLASH RENDERING --------
-    if (flashColor.isValid() && flashAlpha > 0.0f) {
-        QColor overlay = flashColor;
-        overlay.setAlphaF(flashAlpha * 0.5f);
-        painter.fillRect(framePix.rect(), overlay);
-    }
-
-    // ======================================================
-    //               DRAW WIND DUST PARTICLES
-    // ======================================================
-    if (windActive && !windParticles.isEmpty()) {
-        for (auto &wp : windParticles) {
-
-            QColor dust(230, 230, 230);
-            dust.setAlphaF(0.2f + wp.alpha * 0.8f);
-
-            float px = wp.pos.x() * grid_box;
-            float py = wp.pos.y() * grid_box;
-
-            float size = grid_box * 0.30f;
-
-            painter.setBrush(dust);
-            painter.setPen(Qt::NoPen);
-            painter.drawEllipse(QRectF(px, py, size, size));
+    renderer.render(painter, sim, alpha);
+    if (versus) {
+        // Everyone's score along the bottom, this player in brackets
+        QString line;
+        for (int p = 0; p < versus->players(); ++p) {
+            const GameSimulation &other = versus->player(p);
+            QString entry = QString("P%1 %2%3").arg(p + 1).arg(other.score).arg(other.isOver() ? " x" : "");
+            line += (p == versus->localIndex() ? "[" + entry + "]" : entry) + "   ";
         }
-    }
-
-    // ======================================================
-    //               DRAW WIND STREAK ARROWS >>>> <<<<<
-    // ======================================================
-    if (windActive && !windStreaks.isEmpty()) {
-
-        // Font size scales with grid
-        painter.setFont(QFont("Arial", grid_box * 0.9f, QFont::Bold));
-
-        for (auto &ws : windStreaks) {
-
-            bool right = (windStrength > 0);
-            QString arrow = right ? ">>>>" : "<<<<";
-
-            float px = ws.pos.x() * grid_box;
-            float py = ws.pos.y() * grid_box;
-
-            painter.save();
-
-            // Tilt arrows for style
-            painter.translate(px, py);
-            painter.rotate(right ? 20 : -20);
-
-            QColor col(230, 230, 230);
-            col.setAlphaF(ws.alpha * 0.8f);
-
-            painter.setPen(col);
-            painter.drawText(0, 0, arrow);
-
-            painter.restore();
-        }
-    }
-
-    // ======================================================
-    //                       DRAW BASKET
-    // ======================================================
-    painter.setBrush(basketFill);
-    painter.setPen(Qt::NoPen);
-
-    for (int y = 0; y < basketHeightCells; ++y) {
-        float rowY = basketRenderY + y;
-        int taper = std::min(y / 1, basketWidthCells / 6);
-        int startX = -basketWidthCells / 2 + taper;
-        int endX = basketWidthCells / 2 - taper;
-        for (int x = startX; x <= endX; ++x) {
-            float cx = basketRenderX + x;
-            float px = cx * grid_box;
-            float py = rowY * grid_box;
-            painter.fillRect(px, py, grid_box, grid_box, basketFill);
-        }
-    }
-
-    painter.setBrush(Qt::NoBrush);
-    QPen rimPen(basketOutline);
-    rimPen.setWidthF(4.0);
-    rimPen.setCapStyle(Qt::RoundCap);
-    rimPen.setJoinStyle(Qt::RoundJoin);
-    painter.setPen(rimPen);
-
-    QPainterPath rimPath;
-    QPointF leftPoint((basketRenderX - basketWidthCells / 2.0f) * grid_box, basketRenderY * grid_box);
-    QPointF rightPoint((basketRenderX + basketWidthCells / 2.0f) * grid_box, basketRenderY * grid_box);
-    QPointF control(basketRenderX * grid_box, (basketRenderY - basketHeightCells * 0.5f) * grid_box);
-    rimPath.moveTo(leftPoint);
-    rimPath.quadTo(control, rightPoint);
-    painter.drawPath(rimPath);
-
-    // Basket trail
-    int trailLength = 6;
-    for (int i = 1; i <= trailLength; ++i) {
-        int fade = qMax(10, 120 - i * 18);
-        QColor trailColor(160, 82, 45, fade);
-        float trailX = basketRenderX - basketXVelocity * (i * 0.02f);
-        painter.fillRect((trailX - basketWidthCells / 2.0f) * grid_box,
-                         basketRenderY * grid_box,
-                         basketWidthCells * grid_box,
-                         basketHeightCells * grid_box,
-                         trailColor);
-    }
-
-    // ======================================================
-    //                       DRAW EGGS
-    // ======================================================
-    for (auto &egg : eggs) {
-        Egg renderEgg = egg;
-        renderEgg.pos.setY(egg.prevY + (egg.pos.y() - egg.prevY) * alpha);
-        drawEggShape(painter, renderEgg, (float)grid_box);
-    }
-
-    // ======================================================
-    //                           HUD
-    // ======================================================
-    painter.setFont(QFont("Comic Sans MS", 24, QFont::Bold));
-    QColor scoreColor(255, 215, 0);
-    if (focusMode) scoreColor = QColor(0, 255, 255);
-
-    painter.setPen(scoreColor);
-    painter.save();
-    painter.translate(QPointF(30, 45));
-    painter.scale(scoreScale, scoreScale);
-    painter.drawText(QPointF(0, 0), QString("Score: %1").arg(score));
-    painter.restore();
-
-    // High score
-    QFont highFont("Arial", 18, QFont::Bold);
-    painter.setFont(highFont);
-    painter.setPen(QColor(200, 200, 255));
-    painter.drawText(30, 75, QString("High Score: %1").arg(highScore));
-
-    // Focus Mode banner
-    if (focusMode) {
-        painter.setFont(QFont("Arial", 18, QFont::Bold));
-        painter.setPen(QColor(0, 255, 255));
-        painter.drawText(framePix.rect(), Qt::AlignTop | Qt::AlignHCenter,
-                         "FOCUS MODE  x5 SCORE");
-    }
-
-    // Lives (hearts)
-    int heartSize = 24;
-    float pulseScale = 1.0f + 0.5f * (livesPulseTimer / 0.3f);
-    for (int i = 0; i < lives; ++i) {
-        int x = framePix.width() - 40 - i * (heartSize + 5);
-        int y = 20;
-
-        QPainterPath heartPath;
-        heartPath.moveTo(x + heartSize / 2.0, y + heartSize / 5.0);
-        heartPath.cubicTo(x + heartSize / 2.0, y, x, y, x, y + heartSize / 3.0);
-        heartPath.cubicTo(x, y + heartSize * 0.8, x + heartSize / 2.0, y + heartSize,
-                          x + heartSize / 2.0, y + heartSize * 0.9);
-        heartPath.cubicTo(x + heartSize / 2.0, y + heartSize, x + heartSize,
-                          y + heartSize * 0.8, x + heartSize, y + heartSize / 3.0);
-        heartPath.cubicTo(x + heartSize, y, x + heartSize / 2.0, y,
-                          x + heartSize / 2.0, y + heartSize / 5.0);
-
         painter.save();
-        painter.translate(x + heartSize / 2.0, y + heartSize / 2.0);
-        painter.scale(pulseScale, pulseScale);
-        painter.translate(-(x + heartSize / 2.0), -(y + heartSize / 2.0));
-        painter.setBrush(Qt::red);
-        painter.setPen(Qt::NoPen);
-        painter.drawPath(heartPath);
+        painter.scale(canvasScale, canvasScale);
+        painter.setPen(Qt::white);
+        painter.setFont(QFont("Arial", 10, QFont::Bold));
+        painter.drawText(canvasRect().adjusted(0, 0, 0, -4), Qt::AlignHCenter | Qt::AlignBottom, line.trimmed());
         painter.restore();
     }
-
-    // --------------------------------------------------------
-    //               EGG SPLAT PARTICLES (existing)
-    // --------------------------------------------------------
-    painter.setPen(Qt::NoPen);
-    for (auto &p : particles) {
-        QColor c = p.color;
-        c.setAlpha(p.alpha);
-        painter.setBrush(c);
-        painter.setPen(Qt::NoPen);
-        int size = grid_box / 3;
-        painter.drawEllipse(QPointF(p.pos.x() / 1000.0, p.pos.y() / 1000.0) * grid_box,
-                            size, size);
-    }
-
     painter.end();
     ui->frame->setPixmap(framePix);
 }
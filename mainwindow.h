@@ -4,67 +4,50 @@
 #include <QMainWindow>
 #include <QTimer>
 #include <QElapsedTimer>
-#include <QSoundEffect>
 #include <QVector>
 #include <QPixmap>
 #include <QPointF>
+#include <QFont>
+#include <QPainterPath>
+#include <QStaticText>
+#include <limits>
 #include <QLineEdit> // [CHANGE] Added for name input
 #include <QPushButton> // [CHANGE] Added for menu buttons
 
 #include "leaderboardmanager.h"
+#include "gamesim.h"
+#include "gamerenderer.h"
+#include "simsnapshot.h"
+#include "netsession.h"
+#include "broadcast.h"
+#include "basketbot.h"
+#include "profilestore.h"
+#include "analytics.h"
+#include "assetcache.h"
+#include "eggraster.h"
+#include "inputqueue.h"
+#include "audioengine.h"
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
-// In mainwindow.h
-
-struct Egg {
-    QPointF pos;
-    float prevY;
-    float yVelocity;
-    QString state;
-    float animTimer = 0;
-    float scale = 1.0f;
-    float alpha = 1.0f;
-    QString type;    // "normal", "bad", "life"
-    QColor color;    // visual tint
-};
-
-struct Particle {
-    QPoint pos;      // integer position (grid units scaled)
-    QPoint velocity; // integer velocity (scaled)
-    int lifetime;    // in "ticks" (e.g., 60 = 1 second at 60 FPS)
-    int alpha;       // 0-255
-    QColor color;
-};
-
-struct WindParticle {
-    QPointF pos;
-    QPointF vel;
-    float lifetime;     // current life
-    float maxLife;      // total life
-    float alpha;        // fade
-};
-
-struct WindStreak {
-    QPointF pos;
-    float lifetime;
-    float maxLife;
-    float alpha;
-};
-
-
-class MainWindow : public QMainWindow {
+class MainWindow : public QMainWindow, private BasketController {
     Q_OBJECT
 
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Started in main(); the first menu frame reports time since then
+    void setLaunchClock(const QElapsedTimer &clock);
+
 protected:
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
 
 private slots:
     void gameTick();
@@ -74,7 +57,13 @@ private slots:
 private:
 
     LeaderboardManager leaderboardManager;
+    ProfileStore profileStore;
     QString playerName;
+    QString deviceID;          // read once from the profile at startup
+    bool gameOverHandled = false;
+    bool ranked = true;        // false for bot games and once a save state or rewind is used: kept off the high score and leaderboard
+    QElapsedTimer sessionClock;
+    SessionLogger sessionLog;
 
     // [CHANGE] UI elements for the menu/leaderboard
     QPushButton *playButton;
@@ -82,99 +71,106 @@ private:
     QLineEdit *nameInput;
     // [CHANGE] Button to start game from leaderboard screen
     QPushButton *backToMenuButton;
-
-    QVector<Particle> particles;
-    QVector<WindParticle> windParticles;
-    QVector<WindStreak> windStreaks;
-
-
-    int highScore = 0;
+    // Toggles the leaderboard between top 5 and the rows around the player
+    QPushButton *aroundMeButton;
+
+    // The game itself and how it is drawn; MainWindow feeds input and paces frames
+    GameSimulation sim;
+    GameRenderer renderer;
+    RewindBuffer rewindBuffer;      // last 10 s of steps, Backspace rewinds
+    InterceptBot autoBot;           // plays instead of the keys (EGGCATCHER_AUTOPLAY)
+    bool autoplay = false;          // every game is the bot's
+    // Versus over the network (EGGCATCHER_VERSUS); sim is this player's field
+    std::unique_ptr<NetSession> versus;
+    SteerState versusSteer;         // local input, sent instead of steering sim
+    // Spectating: EGGCATCHER_BROADCAST=<port> publishes this game,
+    // EGGCATCHER_WATCH=<host>:<port> shows someone else's
+    std::unique_ptr<BroadcastServer> broadcast;
+    std::unique_ptr<BroadcastViewer> viewer;
 
     Ui::MainWindow *ui;
     QTimer *gameTimer;
     QElapsedTimer frameClock;
 
-    QPixmap background;
+    // ---- Size / DPR: playfield is always grid_size logical units ----
+    std::unique_ptr<AssetCache> assetCache;
+    int canvasSide = 0;          // frame side in device-independent pixels
+    qreal canvasDpr = 1.0;
+    qreal canvasScale = 1.0;     // canvasSide / grid_size, mirrors renderer.scale()
+    QVector<QPair<QWidget *, QRect>> logicalGeometry;   // frame children at grid_size
+
+    // ---- Frame targets (reallocated with the canvas) ----
+    QPixmap frameBuffers[2];     // ping-pong targets, label keeps the other one
+    int frameIndex = 0;
 
     int grid_box;
     int grid_size;
     int cols;
     int rows;
 
-    float globalTime;
-    float globalSpawnTimer;
-    float spawnInterval;
-    float lastEdgeSpawnTime;
-    float edgeSpawnCooldown;
     bool loadingLeaderboard = false;
+    bool leaderboardAroundMe = false;
+    QVector<ScoreEntry> leaderboardRows;   // loaded once per visit, not per frame
+    static constexpr int kAroundMeRows = 2; // neighbours on each side
     float loaderAngle = 0.0f;
 
-    int currentColumnIndex;
-
-    QVector<int> dropColumns;
-    QVector<float> columnTimers;
-    QVector<float> columnDelays;
-
-    QVector<Egg> eggs;
-
-    QPointF basket;
-    float prevBasketX;
-    float basketXVelocity;
-    float basketTargetVel;
-    float basketAccel;
-    float basketMaxVel;
-
-    bool moveLeft;
-    bool moveRight;
-    float flashAlpha;
-    float flashFadeSpeed;
-    QColor flashColor;
-    float flashTimer;
-
-    float fixedDelta;
-    float accumulator;
-
-    float scoreScale = 1.0f;
-    float scoreAnimTimer = 0.0f;
-    bool scoreChanged = false;
-
-    float livesPulseTimer = 0.0f;
-    bool livesChanged = false;
 
-    bool gameOver;
-    bool gameRunning;
-    bool showMenu;
-    bool showLeaderboard;
+    // ---- Input: timestamped edges, applied inside the fixed step ----
+    QElapsedTimer inputClock;
+    InputQueue inputQueue;
+    InputLatencyStats inputLatency;
+    std::unique_ptr<GamepadInput> gamepad;
+    qint64 stepEndNs = 0;        // inputClock time the running step ends at
+    float accumulator;           // real time not yet simulated
+    quint32 pointerSeq = 0;      // last my_label pointer sample consumed
 
-    int score;
-    int lives;
+    // ---- Screens: gameTick only keeps running while one animates ----
+    enum class Screen { Menu, Leaderboard, Playing, GameOver };
+    Screen screen = Screen::Menu;
+    bool framePending = false;   // a one-off redraw is already posted
+    bool screenWatched = false;  // hooked to the window's screenChanged
 
-    QSoundEffect soundCatch;
-    QSoundEffect soundLose;
+    // Cost of sitting on the menu, logged when it is left
+    QElapsedTimer menuWallClock;
+    qint64 menuCpuStartMs = 0;
+    int menuFrames = 0;
 
-    // ---- Wind system ----
-    bool windActive;
-    float windStrength;      // grid cells per second, +/- for left/right
-    float windTimer;         // remaining time for current wind event
-    float windCooldown;      // minimum time between wind events
-    float timeSinceLastWind; // time since last wind ended
+    AudioEngine audio;
+    QElapsedTimer launchClock;
+    bool firstMenuFrameShown = false;
 
-    // ---- Focus mode ----
-    bool focusMode;          // true when in focus mode (score-based cycles)
 
     // ---- Utility Methods ----
+    void setScreen(Screen next);
+    void requestFrame();
+    bool screenAnimates() const;
+    void logMenuIdle();
     void resetGame();
-    void updatePhysics(float dt);
+    void stepBasket(float dt);
+    void moveBasket(GameSimulation &, float dt) override { stepBasket(dt); }
+    void pushKeyEdge(int key, bool pressed);
+    void startVersus();
+    void sampleVersusInput();
+    void rewindGame(int steps);
+    void quickSave();
+    void quickLoad();
+    void loadDeferredAssets();
     void drawGame(float alpha);
     void drawGameOver();
     void drawMenu();
     void drawLeaderboard();
     void drawStartScreen();
-    void drawEggShape(QPainter &p, const Egg &egg, float cellSize);
+    void rebuildRenderCache();
+    void layoutCanvas();
+    void applyRenderAssets(std::shared_ptr<const RenderAssets> assets);
+    QPixmap screenCanvas() const;
+    QRect canvasRect() const { return QRect(0, 0, grid_size, grid_size); }
     void loadHighScore();
     void saveHighScore();
     void handleGameOver();
-    QString getDeviceID();
+    void reloadLeaderboard();
+    void onGameEvent(GameEventKind kind, EggType type, float value, float x);
+    float sessionTime() const { return sim.globalTime; }
 };
 
 #endif // MAINWINDOW_H
@@ -1,16 +1,33 @@
 #include "my_label.h"
 
+#include <QMetaMethod>
+#include <QTouchEvent>
+
 my_label::my_label(QWidget *parent) : QLabel(parent)
 {
     this->setMouseTracking(true);
+    this->setAttribute(Qt::WA_AcceptTouchEvents);
+}
+
+void my_label::record(QPointF pos, bool active)
+{
+    sample.pos = pos;
+    sample.timeNs = inputClock ? inputClock->nsecsElapsed() : 0;
+    sample.active = active;
+    ++sample.seq;
 }
 
 void my_label::mouseMoveEvent(QMouseEvent *ev)
 {
     QPointF pos = ev->position();
     if (pos.x() >= 0 && pos.y() >= 0 && pos.x() < this->width() && pos.y() < this->height()) {
-        QPoint mousepos = pos.toPoint();
-        emit sendMousePosition(mousepos);
+        record(pos, true);
+
+        // Only pay for the signal when someone listens (1000 Hz mice)
+        if (isSignalConnected(QMetaMethod::fromSignal(&my_label::sendMousePosition))) {
+            QPoint mousepos = pos.toPoint();
+            emit sendMousePosition(mousepos);
+        }
     }
 }
 
@@ -22,3 +39,24 @@ void my_label::mousePressEvent(QMouseEvent *ev)
         emit Mouse_Pos();
     }
 }
+
+bool my_label::event(QEvent *ev)
+{
+    switch (ev->type()) {
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate: {
+        auto *touch = static_cast<QTouchEvent *>(ev);
+        if (!touch->points().isEmpty())
+            record(touch->points().first().position(), true);
+        ev->accept();
+        return true;
+    }
+    case QEvent::TouchEnd:
+    case QEvent::TouchCancel:
+        record(sample.pos, false);
+        ev->accept();
+        return true;
+    default:
+        return QLabel::event(ev);
+    }
+}
@@ -3,6 +3,9 @@
 
 #include <QLabel>
 #include <QMouseEvent>
+#include <QElapsedTimer>
+
+#include "inputqueue.h"
 
 class my_label : public QLabel
 {
@@ -11,13 +14,24 @@ public:
     explicit my_label(QWidget *parent = nullptr);
     int x, y;
 
+    // Mouse/touch moves only overwrite this; readers poll it
+    const PointerSample &pointerSample() const { return sample; }
+    void setInputClock(const QElapsedTimer *clock) { inputClock = clock; }
+
 protected:
     void mouseMoveEvent(QMouseEvent *ev);
     void mousePressEvent(QMouseEvent *ev);
+    bool event(QEvent *ev) override;
 
 signals:
     void sendMousePosition(QPoint&);
     void Mouse_Pos();
+
+private:
+    void record(QPointF pos, bool active);
+
+    PointerSample sample;
+    const QElapsedTimer *inputClock = nullptr;
 };
 
 #endif // MY_LABEL_H
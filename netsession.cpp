@@ -0,0 +1,379 @@
+#include "netsession.h"
+#include "simsnapshot.h"
+
+#include <QDebug>
+#include <QStringList>
+#include <QTimer>
+#include <QUdpSocket>
+#include <algorithm>
+#include <cstring>
+
+static const char kMagic[4] = { 'E', 'G', 'G', 'N' };
+static const quint8 kVersion = 1;
+static const int kHeaderSize = 4 + 4 + 4 + 4 + 4 + 8;
+static const int kInputSize = 3;
+static const int kMaxSend = 40;         // inputs per packet
+
+/* -------------------------------------------------------------
+   Input on the wire
+--------------------------------------------------------------*/
+NetInput NetInput::fromSteer(const SteerState &steer)
+{
+    NetInput in;
+    if (steer.holding(InputAction::Left))
+        in.buttons |= Left;
+    if (steer.holding(InputAction::Right))
+        in.buttons |= Right;
+    if (steer.pointerHeld()) {
+        in.buttons |= Pointer;
+        in.pointer = qint16(std::clamp(qRound(steer.pointerColumn() * 16.0f), -32768, 32767));
+    }
+    return in;
+}
+
+SteerState NetInput::toSteer() const
+{
+    SteerState steer;
+    if (buttons & Left)
+        steer.apply({ 0, InputSource::Keyboard, InputAction::Left, true });
+    if (buttons & Right)
+        steer.apply({ 0, InputSource::Keyboard, InputAction::Right, true });
+    if (buttons & Pointer)
+        steer.setPointer(pointer / 16.0f);
+    return steer;
+}
+
+static quint64 fnv1a(quint64 hash, const QByteArray &data)
+{
+    for (char c : data) {
+        hash ^= quint8(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* -------------------------------------------------------------
+   Session
+--------------------------------------------------------------*/
+bool NetSession::parseSpec(const QString &spec, Config &config)
+{
+    config.peers.clear();
+    int at = spec.indexOf('@');
+    bool ok = false;
+    if (at < 0) {
+        const QStringList parts = spec.split(':');
+        const int players = parts.value(0).toInt(&ok);
+        if (!ok || parts.size() != 2)
+            return false;
+        config.localIndex = parts[1].toInt(&ok) - 1;
+        for (int p = 0; p < players; ++p)
+            config.peers.append({ QHostAddress(QHostAddress::LocalHost), quint16(kBasePort + p) });
+    } else {
+        config.localIndex = spec.left(at).toInt(&ok) - 1;
+        for (const QString &entry : spec.mid(at + 1).split(',')) {
+            const int colon = entry.lastIndexOf(':');
+            NetPeer peer{ QHostAddress(entry.left(colon)), quint16(entry.mid(colon + 1).toUInt()) };
+            if (colon < 0 || peer.address.isNull() || peer.port == 0)
+                return false;
+            config.peers.append(peer);
+        }
+    }
+    return ok && config.peers.size() >= 2 && config.peers.size() <= kMaxPlayers
+           && config.localIndex >= 0 && config.localIndex < config.peers.size();
+}
+
+NetSession::NetSession(GameSimulation &local, const Config &config, QObject *owner)
+    : config(config),
+    local(local),
+    lossRng(config.seed ^ quint32(config.localIndex))
+{
+    const int n = int(config.peers.size());
+    if (n < 2 || n > kMaxPlayers || config.localIndex < 0 || config.localIndex >= n
+        || config.maxRollback < 1 || config.inputDelay < 1
+        || 2 * (config.inputDelay + config.maxRollback) + 2 > kMaxSend) {
+        qDebug() << "VERSUS: bad session config," << n << "players";
+        return;
+    }
+
+    localController = local.controller;
+    local.controller = nullptr;     // steps take the networked input
+    local.reset(config.seed);
+    local.highScore = 0;
+    for (int p = 0; p < n; ++p) {
+        if (p == config.localIndex) {
+            sims.push_back(&local);
+            continue;
+        }
+        auto sim = std::make_unique<GameSimulation>(local.cols, local.rows);
+        sim->dropColumns = local.dropColumns;
+        sim->reset(config.seed);
+        sims.push_back(sim.get());
+        remotes.push_back(std::move(sim));
+    }
+
+    // The first inputDelay steps have nobody's input: neutral for all
+    inputs.assign(n, {});
+    knownUpTo.assign(n, config.inputDelay - 1);
+    ackedBy.assign(n, config.inputDelay - 1);
+    for (auto &slot : states)
+        slot.resize(n);
+    stateFrame.fill(-1);
+    syncHistory.fill(0);
+
+    socket = new QUdpSocket(owner);
+    const NetPeer &self = config.peers[config.localIndex];
+    if (!socket->bind(self.address, self.port)) {
+        qDebug() << "VERSUS: CANNOT BIND" << self.address.toString() << self.port << socket->errorString();
+        return;
+    }
+    open = true;
+}
+
+NetSession::~NetSession()
+{
+    if (!sims.empty())
+        local.controller = localController;
+    delete socket;
+}
+
+bool NetSession::allOver() const
+{
+    return std::all_of(sims.begin(), sims.end(), [](const GameSimulation *s) { return s->isOver(); });
+}
+
+int NetSession::confirmedFrame() const
+{
+    return knownUpTo.empty() ? -1 : *std::min_element(knownUpTo.begin(), knownUpTo.end());
+}
+
+bool NetSession::advance(const NetInput &input)
+{
+    if (!open)
+        return false;
+
+    receive();
+    if (rollbackFrom < current)
+        rollback();
+
+    if (current - confirmedFrame() > config.maxRollback) {
+        // Too far ahead of someone: wait, but keep them fed
+        ++counters.stalls;
+        send();
+        return false;
+    }
+
+    const int me = config.localIndex;
+    inputAt(me, current + config.inputDelay) = input;
+    knownUpTo[me] = current + config.inputDelay;
+    send();
+
+    saveState(current);
+    stepFrame(current);
+    ++current;
+    updateSync();
+    return true;
+}
+
+// Steps every player once; missing inputs repeat the last known one
+void NetSession::stepFrame(int frame)
+{
+    for (int p = 0; p < players(); ++p) {
+        if (frame > knownUpTo[p])
+            inputAt(p, frame) = inputAt(p, knownUpTo[p]);
+        GameSimulation &sim = *sims[p];
+        sim.steer = inputAt(p, frame).toSteer();
+        sim.step(sim.fixedDelta);
+    }
+}
+
+void NetSession::rollback()
+{
+    const int from = rollbackFrom;
+    rollbackFrom = INT_MAX;
+    if (!loadState(from)) {
+        qDebug() << "VERSUS: no snapshot for step" << from << ", state may drift";
+        return;
+    }
+
+    // The player already heard these steps once
+    auto sink = std::move(local.onEvent);
+    local.onEvent = nullptr;
+    for (int f = from; f < current; ++f) {
+        if (f > from)
+            saveState(f);
+        stepFrame(f);
+    }
+    local.onEvent = std::move(sink);
+
+    ++counters.rollbacks;
+    counters.replayedSteps += current - from;
+}
+
+void NetSession::saveState(int frame)
+{
+    const int slot = frame % kHistory;
+    for (int p = 0; p < players(); ++p)
+        SimSnapshot::save(*sims[p], states[slot][p]);
+    stateFrame[slot] = frame;
+}
+
+bool NetSession::loadState(int frame)
+{
+    const int slot = frame % kHistory;
+    if (stateFrame[slot] != frame)
+        return false;
+    for (int p = 0; p < players(); ++p) {
+        if (!SimSnapshot::load(*sims[p], states[slot][p]))
+            return false;
+    }
+    return true;
+}
+
+// Folds in each step that is confirmed and already run with the
+// actual inputs
+void NetSession::updateSync()
+{
+    const int last = std::min({ confirmedFrame(), current - 1, rollbackFrom - 1 });
+    while (syncedFrame < last) {
+        const int after = syncedFrame + 2;     // state after step syncedFrame + 1
+        quint64 hash = syncHash ^ 1469598103934665603ULL;
+        for (int p = 0; p < players(); ++p) {
+            if (after == current) {
+                SimSnapshot::save(*sims[p], syncScratch);
+                hash = fnv1a(hash, syncScratch);
+            } else if (stateFrame[after % kHistory] == after) {
+                hash = fnv1a(hash, states[after % kHistory][p]);
+            } else {
+                return;
+            }
+        }
+        ++syncedFrame;
+        syncHash = hash;
+        syncHistory[syncedFrame % kHistory] = hash;
+    }
+}
+
+bool NetSession::syncHashAt(int frame, quint64 &hash) const
+{
+    if (frame < 0 || frame > syncedFrame || frame <= syncedFrame - kHistory)
+        return false;
+    hash = syncHistory[frame % kHistory];
+    return true;
+}
+
+/* -------------------------------------------------------------
+   Packets
+       "EGGN" u8 version, u8 from, u8 count, u8 0
+       i32 ack        the receiver's inputs we have, up to here
+       i32 first      step of the first input below
+       i32 syncFrame  u64 syncHash
+       count x (u8 buttons, i16 pointer)
+--------------------------------------------------------------*/
+void NetSession::send()
+{
+    const int me = config.localIndex;
+    const int newest = knownUpTo[me];
+    for (int p = 0; p < players(); ++p) {
+        if (p == me)
+            continue;
+
+        const int first = std::max(ackedBy[p] + 1, newest - kHistory + 1);
+        const int count = std::clamp(newest - first + 1, 0, kMaxSend);
+
+        QByteArray packet(kHeaderSize + count * kInputSize, Qt::Uninitialized);
+        char *w = packet.data();
+        std::memcpy(w, kMagic, 4);
+        w[4] = char(kVersion);
+        w[5] = char(me);
+        w[6] = char(count);
+        w[7] = 0;
+        qint32 header[3] = { knownUpTo[p], first, syncedFrame };
+        std::memcpy(w + 8, header, sizeof(header));
+        std::memcpy(w + 20, &syncHash, 8);
+        w += kHeaderSize;
+        for (int i = 0; i < count; ++i, w += kInputSize) {
+            const NetInput &in = inputAt(me, first + i);
+            w[0] = char(in.buttons);
+            std::memcpy(w + 1, &in.pointer, 2);
+        }
+        sendTo(p, packet);
+    }
+}
+
+void NetSession::sendTo(int player, const QByteArray &packet)
+{
+    ++counters.sent;
+    if (config.lossPercent > 0 && lossRng.bounded(100) < config.lossPercent) {
+        ++counters.dropped;
+        return;
+    }
+
+    const NetPeer peer = config.peers[player];
+    if (config.latencyMs > 0) {
+        QUdpSocket *s = socket;
+        QTimer::singleShot(config.latencyMs, s, [s, packet, peer]() {
+            s->writeDatagram(packet, peer.address, peer.port);
+        });
+    } else {
+        socket->writeDatagram(packet, peer.address, peer.port);
+    }
+}
+
+void NetSession::receive()
+{
+    if (!open)
+        return;
+    QByteArray packet;
+    while (socket->hasPendingDatagrams()) {
+        packet.resize(int(qMax<qint64>(0, socket->pendingDatagramSize())));
+        if (socket->readDatagram(packet.data(), packet.size()) < 0)
+            continue;
+        handlePacket(packet);
+    }
+}
+
+void NetSession::handlePacket(const QByteArray &packet)
+{
+    const char *r = packet.constData();
+    if (packet.size() < kHeaderSize || std::memcmp(r, kMagic, 4) != 0 || quint8(r[4]) != kVersion)
+        return;
+    const int from = quint8(r[5]);
+    const int count = quint8(r[6]);
+    if (from >= players() || from == config.localIndex || packet.size() != kHeaderSize + count * kInputSize)
+        return;
+    ++counters.received;
+
+    qint32 header[3];
+    quint64 theirHash;
+    std::memcpy(header, r + 8, sizeof(header));
+    std::memcpy(&theirHash, r + 20, 8);
+    const int ack = header[0];
+    const int first = header[1];
+    const int theirSynced = header[2];
+
+    ackedBy[from] = std::max(ackedBy[from], ack);
+
+    r += kHeaderSize;
+    for (int i = 0; i < count; ++i, r += kInputSize) {
+        const int f = first + i;
+        if (f <= knownUpTo[from])
+            continue;
+        if (f != knownUpTo[from] + 1)
+            break;                  // a gap: the next packet resends from our ack
+
+        NetInput in;
+        in.buttons = quint8(r[0]);
+        std::memcpy(&in.pointer, r + 1, 2);
+        // Already run on a guess that was wrong: redo from there
+        if (f < current && inputAt(from, f) != in)
+            rollbackFrom = std::min(rollbackFrom, f);
+        inputAt(from, f) = in;
+        knownUpTo[from] = f;
+    }
+
+    quint64 ours;
+    if (!desync && syncHashAt(theirSynced, ours) && ours != theirHash) {
+        desync = true;
+        qDebug() << "VERSUS: DESYNC with player" << from + 1 << "at step" << theirSynced;
+    }
+}
@@ -0,0 +1,149 @@
+#ifndef NETSESSION_H
+#define NETSESSION_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QRandomGenerator>
+#include <QVector>
+#include <array>
+#include <climits>
+#include <memory>
+#include <vector>
+
+#include "gamesim.h"
+
+class QObject;
+class QUdpSocket;
+
+// One player's input for one fixed step, as it goes over the wire
+struct NetInput {
+    enum : quint8 { Left = 1, Right = 2, Pointer = 4 };
+    quint8 buttons = 0;
+    qint16 pointer = 0;         // column * 16, when Pointer is set
+
+    static NetInput fromSteer(const SteerState &steer);
+    SteerState toSteer() const;
+    bool operator==(const NetInput &o) const { return buttons == o.buttons && pointer == o.pointer; }
+    bool operator!=(const NetInput &o) const { return !(*this == o); }
+};
+
+struct NetPeer {
+    QHostAddress address;
+    quint16 port = 0;
+};
+
+// ======================================================
+// Versus over UDP, 2 to 8 players racing the same eggs
+//
+// Every peer runs every player's simulation from one seed, in
+// lock-step on the fixed-step number, so only inputs travel.
+// A player's own input is applied inputDelay steps late, which
+// gives it that long to reach the others. Inputs that are
+// still missing are predicted (the last one known, held), and
+// when the real one turns out different the simulations go
+// back to a snapshot of that step and run forward again. A
+// peer more than maxRollback steps behind stalls the rest
+// until it catches up.
+//
+// Packets carry every input the receiver has not acknowledged,
+// so a lost packet is covered by the next one, and a hash of
+// the confirmed state to catch peers that drift apart.
+// ======================================================
+class NetSession
+{
+public:
+    static constexpr int kMaxPlayers = 8;
+    static constexpr int kHistory = 64;       // steps of inputs and snapshots kept
+    static constexpr quint16 kBasePort = 47000;
+
+    struct Config {
+        QVector<NetPeer> peers;     // one per player; this process binds peers[localIndex]
+        int localIndex = 0;
+        quint32 seed = 1;
+        int inputDelay = 3;         // steps (25 ms)
+        int maxRollback = 12;       // steps (100 ms)
+
+        // Testing on one machine: outgoing packets dropped / held back
+        int lossPercent = 0;
+        int latencyMs = 0;
+    };
+
+    struct Stats {
+        int rollbacks = 0;
+        qint64 replayedSteps = 0;
+        int stalls = 0;
+        qint64 sent = 0;
+        qint64 dropped = 0;
+        qint64 received = 0;
+    };
+
+    // "<players>:<you>" for peers on this machine (ports 47000 up)
+    // or "<you>@host:port,host:port,..." listing every player;
+    // players count from 1
+    static bool parseSpec(const QString &spec, Config &config);
+
+    // `local` becomes this player's simulation, reset to the
+    // shared seed with highScore 0 like every other copy (it is part
+    // of the hashed state, and peers do not know each other's best);
+    // its controller is set aside until the session ends
+    NetSession(GameSimulation &local, const Config &config, QObject *owner);
+    ~NetSession();
+
+    bool isOpen() const { return open; }
+    int players() const { return int(sims.size()); }
+    int localIndex() const { return config.localIndex; }
+    const GameSimulation &player(int index) const { return *sims[index]; }
+    bool allOver() const;
+
+    // One fixed step with this player's input. False, with nothing
+    // stepped, while a peer is too far behind.
+    bool advance(const NetInput &input);
+    // Takes what the socket has; advance() does this first
+    void receive();
+
+    int frame() const { return current; }      // next step to run
+    int confirmedFrame() const;                // last step with every input known
+    // Hash chained over the state after each confirmed step, for
+    // the last kHistory of them
+    bool syncHashAt(int frame, quint64 &hash) const;
+    bool desynced() const { return desync; }
+    const Stats &stats() const { return counters; }
+
+private:
+    NetInput &inputAt(int player, int frame) { return inputs[player][frame % kHistory]; }
+    void stepFrame(int frame);
+    void rollback();
+    void saveState(int frame);
+    bool loadState(int frame);
+    void updateSync();
+    void send();
+    void sendTo(int player, const QByteArray &packet);
+    void handlePacket(const QByteArray &packet);
+
+    Config config;
+    bool open = false;
+    GameSimulation &local;
+    BasketController *localController = nullptr;
+    std::vector<std::unique_ptr<GameSimulation>> remotes;
+    std::vector<GameSimulation *> sims;                 // by player
+
+    std::vector<std::array<NetInput, kHistory>> inputs; // actual or predicted
+    std::vector<int> knownUpTo;     // per player: every input up to here is actual
+    std::vector<int> ackedBy;       // per player: our inputs they have, up to here
+    std::array<std::vector<QByteArray>, kHistory> states;   // per player, before the step
+    std::array<int, kHistory> stateFrame;
+    int current = 0;
+    int rollbackFrom = INT_MAX;
+
+    int syncedFrame = -1;
+    quint64 syncHash = 0;
+    std::array<quint64, kHistory> syncHistory;
+    QByteArray syncScratch;
+    bool desync = false;
+
+    QUdpSocket *socket = nullptr;
+    QRandomGenerator lossRng;
+    Stats counters;
+};
+
+#endif // NETSESSION_H
@@ -0,0 +1,161 @@
+#ifndef PARTICLEPOOL_H
+#define PARTICLEPOOL_H
+
+#include <QPoint>
+#include <QPointF>
+#include <QtGlobal>
+#include <algorithm>
+#include <vector>
+
+// Particles never change after they spawn: where they are and
+// how faded is worked out from their age in fixed steps. The
+// steps they have moved by `step` counts the spawn step itself.
+inline int movesAt(quint32 born, quint32 step) { return int(step - born) + 1; }
+
+// Splat particle
+struct Particle {
+    QPoint origin;      // spawn position (grid units scaled)
+    QPoint velocity;    // scaled, moves velocity / 60 per step
+    quint32 born = 0;   // GameSimulation::stepCount at spawn
+    qint16 life = 0;    // steps it lives
+    quint8 palette = 0; // colour index: the EggType whose tint it carries
+
+    bool aliveAt(quint32 step) const { return movesAt(born, step) < life; }
+    QPoint posAt(quint32 step) const { return origin + (velocity / 60) * movesAt(born, step); }
+    int alphaAt(quint32 step) const { return std::max(0, ((life - movesAt(born, step)) * 255) / 60); }
+};
+
+// Wind dust
+struct WindParticle {
+    QPointF origin;
+    QPointF vel;        // grid cells per 1/60 s
+    float maxLife = 0;  // seconds
+    quint32 born = 0;
+
+    float lifetimeAt(quint32 step, float dt) const { return maxLife - movesAt(born, step) * dt; }
+    bool aliveAt(quint32 step, float dt) const { return lifetimeAt(step, dt) > 0; }
+    QPointF posAt(quint32 step, float dt) const { return origin + vel * (dt * 60.0f * movesAt(born, step)); }
+    float alphaAt(quint32 step, float dt) const { return std::max(0.0f, lifetimeAt(step, dt) / maxLife); }
+};
+
+// Wind arrow
+struct WindStreak {
+    QPointF pos;
+    float maxLife = 0;
+    quint32 born = 0;
+
+    float lifetimeAt(quint32 step, float dt) const { return maxLife - movesAt(born, step) * dt; }
+    bool aliveAt(quint32 step, float dt) const { return lifetimeAt(step, dt) > 0; }
+    float alphaAt(quint32 step, float dt) const { return std::max(0.0f, lifetimeAt(step, dt) / maxLife); }
+};
+
+// ======================================================
+// Fixed-capacity ring of particles
+//
+// Slots are handed out in birth order, a burst always gets a
+// contiguous run. When the budget is used up the oldest
+// particles are overwritten, so memory never grows however
+// many eggs splat at once. Particles that die mid-ring stay as
+// holes until the oldest end passes them. A slot keeps its
+// record until it is reused, which also keeps consecutive
+// snapshots aligned slot for slot.
+// ======================================================
+template <typename T>
+class ParticleRing
+{
+public:
+    explicit ParticleRing(int budget) { setBudget(budget); }
+
+    // Drops every particle
+    void setBudget(int budget)
+    {
+        slots.assign(std::max(1, budget), T{});
+        clear();
+    }
+    int budget() const { return int(slots.size()); }
+    void clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+    // Slots in use from the oldest, holes included
+    int used() const { return count; }
+    int oldest() const { return head; }
+    const std::vector<T> &slotData() const { return slots; }
+
+    // Snapshot restore; false if the layout does not fit
+    bool restore(std::vector<T> data, int oldestSlot, int usedSlots)
+    {
+        if (data.empty() || oldestSlot < 0 || oldestSlot >= int(data.size())
+            || usedSlots < 0 || usedSlots > int(data.size()))
+            return false;
+        slots = std::move(data);
+        head = oldestSlot;
+        count = usedSlots;
+        return true;
+    }
+
+    // `n` contiguous slots for one burst (at most the budget); the
+    // caller fills every one
+    T *spawnBurst(int n)
+    {
+        const int cap = int(slots.size());
+        n = std::clamp(n, 0, cap);
+        if (count == 0)
+            head = 0;
+
+        int tail = (head + count) % cap;
+        if (tail + n > cap) {
+            // Not enough run before the end: the gap becomes dead slots
+            int gap = cap - tail;
+            makeRoom(gap);
+            std::fill(slots.begin() + tail, slots.end(), T{});
+            count += gap;
+            tail = 0;
+        }
+
+        makeRoom(n);
+        count += n;
+        return slots.data() + tail;
+    }
+    T &spawn() { return *spawnBurst(1); }
+
+    // Moves the oldest end past dead particles
+    template <typename Alive>
+    void retire(Alive &&alive)
+    {
+        const int cap = int(slots.size());
+        while (count > 0 && !alive(slots[head])) {
+            head = head + 1 == cap ? 0 : head + 1;
+            --count;
+        }
+    }
+
+    // Every slot in use, oldest first; callers skip the dead
+    template <typename F>
+    void forEach(F &&f) const
+    {
+        const int cap = int(slots.size());
+        for (int i = 0, s = head; i < count; ++i, s = s + 1 == cap ? 0 : s + 1)
+            f(slots[s]);
+    }
+
+private:
+    // Oldest-first eviction until n more slots fit
+    void makeRoom(int n)
+    {
+        const int cap = int(slots.size());
+        int excess = count + n - cap;
+        if (excess <= 0)
+            return;
+        head = (head + excess) % cap;
+        count -= excess;
+    }
+
+    std::vector<T> slots;
+    int head = 0;      // oldest slot
+    int count = 0;     // slots from head that are in use
+};
+
+#endif // PARTICLEPOOL_H
@@ -0,0 +1,218 @@
+#include "profilestore.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QUuid>
+#include <cstring>
+
+/* -------------------------------------------------------------
+   FILE LAYOUT (little endian)
+     char[4]  magic "EGGP"
+     quint16  version
+     quint32  payload size
+     quint16  payload checksum (CRC-16)
+     ...      payload (QDataStream)
+--------------------------------------------------------------*/
+static const char kMagic[4] = { 'E', 'G', 'G', 'P' };
+static const quint16 kVersion = 1;
+static const int kHeaderSize = 4 + 2 + 4 + 2;
+// Pinned so the payload does not follow the Qt that built us
+// (5.15 and 6.x write these types the same)
+static const QDataStream::Version kStreamVersion = QDataStream::Qt_5_15;
+
+ProfileStore::ProfileStore(const QString &dirPath)
+    : dir(dirPath),
+    filePath(dirPath + "/profile.bin")
+{
+    QDir().mkpath(dir);
+    writer.setMaxThreadCount(1);   // one writer keeps saves in order
+
+    bool dirty = !loadBinary();
+    if (dirty)
+        migrateLegacy();
+
+    if (data.deviceId.isEmpty()) {
+        data.deviceId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        dirty = true;
+    }
+
+    if (dirty)
+        save();
+}
+
+ProfileStore::~ProfileStore()
+{
+    flush();
+}
+
+void ProfileStore::setName(const QString &name)
+{
+    data.name = name;
+}
+
+void ProfileStore::setHighScore(int score)
+{
+    data.highScore = score;
+}
+
+void ProfileStore::setSettings(const ProfileSettings &settings)
+{
+    data.settings = settings;
+}
+
+void ProfileStore::addSession(int score, int durationMs)
+{
+    if (data.sessions.size() >= kMaxSessions)
+        data.sessions.remove(0, data.sessions.size() - kMaxSessions + 1);
+
+    data.sessions.append({ QDateTime::currentMSecsSinceEpoch(), score, durationMs });
+}
+
+/* -------------------------------------------------------------
+   SAVE: serialize on the caller, write on the worker
+--------------------------------------------------------------*/
+void ProfileStore::save()
+{
+    QByteArray bytes = serialize();
+    QString path = filePath;
+
+    writer.start([path, bytes]() {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qDebug() << "FAILED TO OPEN PROFILE:" << path;
+            return;
+        }
+        file.write(bytes);
+        if (!file.commit())
+            qDebug() << "FAILED TO WRITE PROFILE:" << path;
+    });
+}
+
+void ProfileStore::flush()
+{
+    writer.waitForDone();
+}
+
+/* -------------------------------------------------------------
+   LOAD: map the file and parse straight from the mapping
+--------------------------------------------------------------*/
+bool ProfileStore::loadBinary()
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < kHeaderSize)
+        return false;
+
+    qint64 size = file.size();
+    uchar *mem = file.map(0, size);
+    if (!mem)
+        return false;
+
+    bool ok = deserialize(QByteArray::fromRawData(reinterpret_cast<const char *>(mem), size));
+    file.unmap(mem);
+
+    if (!ok)
+        qDebug() << "Ignoring corrupt profile:" << filePath;
+    return ok;
+}
+
+void ProfileStore::migrateLegacy()
+{
+    QFile info(dir + "/player_info.txt");
+    if (info.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QTextStream in(&info);
+        QString name = in.readLine().trimmed();
+        data.name = name.isEmpty() ? "Player" : name;
+        data.highScore = in.readLine().toInt();
+    }
+
+    QFile id(dir + "/device_id.txt");
+    if (id.open(QIODevice::ReadOnly | QIODevice::Text))
+        data.deviceId = QString::fromUtf8(id.readAll().trimmed());
+}
+
+QByteArray ProfileStore::serialize() const
+{
+    QByteArray payload;
+    {
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(kStreamVersion);
+        out.setByteOrder(QDataStream::LittleEndian);
+        out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+        out << data.deviceId << data.name << qint32(data.highScore);
+        out << data.settings.sfxVolume;
+        out << quint32(data.sessions.size());
+        for (const SessionRecord &s : data.sessions)
+            out << s.endedAtMs << s.score << s.durationMs;
+    }
+
+    QByteArray bytes;
+    bytes.reserve(kHeaderSize + payload.size());
+    {
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        out.setByteOrder(QDataStream::LittleEndian);
+        out.writeRawData(kMagic, 4);
+        out << kVersion << quint32(payload.size()) << qChecksum(payload);
+    }
+    bytes.append(payload);
+    return bytes;
+}
+
+bool ProfileStore::deserialize(const QByteArray &raw)
+{
+    if (raw.size() < kHeaderSize || memcmp(raw.constData(), kMagic, 4) != 0)
+        return false;
+
+    QDataStream head(raw);
+    head.setByteOrder(QDataStream::LittleEndian);
+    head.skipRawData(4);
+
+    quint16 version = 0;
+    quint32 payloadSize = 0;
+    quint16 checksum = 0;
+    head >> version >> payloadSize >> checksum;
+
+    if (version > kVersion || payloadSize > quint32(raw.size() - kHeaderSize))
+        return false;
+
+    QByteArray payload = QByteArray::fromRawData(raw.constData() + kHeaderSize, payloadSize);
+    if (qChecksum(payload) != checksum)
+        return false;
+
+    QDataStream in(payload);
+    in.setVersion(kStreamVersion);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    Profile p;
+    qint32 high = 0;
+    quint32 count = 0;
+    in >> p.deviceId >> p.name >> high;
+    in >> p.settings.sfxVolume;
+    in >> count;
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    p.highScore = high;
+    count = qMin<quint32>(count, kMaxSessions);
+    p.sessions.reserve(count);
+    for (quint32 i = 0; i < count; ++i) {
+        SessionRecord s;
+        in >> s.endedAtMs >> s.score >> s.durationMs;
+        p.sessions.append(s);
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    if (p.name.isEmpty())
+        p.name = "Player";
+
+    // QDataStream gave us deep copies, safe to drop the mapping now
+    data = p;
+    return true;
+}
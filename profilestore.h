@@ -0,0 +1,64 @@
+#ifndef PROFILESTORE_H
+#define PROFILESTORE_H
+
+#include <QString>
+#include <QVector>
+#include <QThreadPool>
+
+struct SessionRecord {
+    qint64 endedAtMs;   // ms since epoch
+    qint32 score;
+    qint32 durationMs;
+};
+
+struct ProfileSettings {
+    float sfxVolume = 1.0f;
+};
+
+struct Profile {
+    QString deviceId;
+    QString name = "Player";
+    int highScore = 0;
+    ProfileSettings settings;
+    QVector<SessionRecord> sessions;   // oldest first, capped at kMaxSessions
+};
+
+// ======================================================
+// Local player profile, stored as one versioned binary file.
+// Reads go through a memory map, writes are atomic (write temp + rename)
+// and happen on a single background thread so they stay ordered.
+// ======================================================
+class ProfileStore
+{
+public:
+    static constexpr int kMaxSessions = 256;
+
+    explicit ProfileStore(const QString &dirPath);
+    ~ProfileStore();
+
+    const Profile &profile() const { return data; }
+    const QString &deviceId() const { return data.deviceId; }
+
+    void setName(const QString &name);
+    void setHighScore(int score);
+    void setSettings(const ProfileSettings &settings);
+    void addSession(int score, int durationMs);
+
+    // Snapshot the profile and queue an atomic write
+    void save();
+    // Block until queued writes are on disk
+    void flush();
+
+private:
+    bool loadBinary();
+    void migrateLegacy();
+    QByteArray serialize() const;
+    bool deserialize(const QByteArray &raw);
+
+    QString dir;
+    QString filePath;
+    Profile data;
+    QThreadPool writer;
+};
+
+#endif // PROFILESTORE_H
@@ -0,0 +1,167 @@
+#include "rankindex.h"
+
+RankIndex::RankIndex() = default;
+
+void RankIndex::reserve(int n)
+{
+    nodes.reserve(n);
+}
+
+void RankIndex::clear()
+{
+    nodes.clear();
+    freeList.clear();
+    root = -1;
+}
+
+int RankIndex::allocNode(int score, quint32 slot)
+{
+    // xorshift keeps priorities reproducible between runs
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    Node node{ score, slot, seed, -1, -1, 1 };
+    if (!freeList.empty()) {
+        int n = freeList.back();
+        freeList.pop_back();
+        nodes[n] = node;
+        return n;
+    }
+    nodes.push_back(node);
+    return int(nodes.size()) - 1;
+}
+
+/* -------------------------------------------------------------
+   split: left gets everything ordered before (score, slot)
+--------------------------------------------------------------*/
+void RankIndex::split(int n, int score, quint32 slot, int &left, int &right)
+{
+    if (n < 0) {
+        left = right = -1;
+        return;
+    }
+    if (before(nodes[n].score, nodes[n].slot, score, slot)) {
+        split(nodes[n].right, score, slot, nodes[n].right, right);
+        left = n;
+    } else {
+        split(nodes[n].left, score, slot, left, nodes[n].left);
+        right = n;
+    }
+    update(n);
+}
+
+int RankIndex::merge(int left, int right)
+{
+    if (left < 0) return right;
+    if (right < 0) return left;
+
+    if (nodes[left].priority > nodes[right].priority) {
+        nodes[left].right = merge(nodes[left].right, right);
+        update(left);
+        return left;
+    }
+    nodes[right].left = merge(left, nodes[right].left);
+    update(right);
+    return right;
+}
+
+void RankIndex::insert(int score, quint32 slot)
+{
+    int node = allocNode(score, slot);
+    int left, right;
+    split(root, score, slot, left, right);
+    root = merge(merge(left, node), right);
+}
+
+void RankIndex::erase(int score, quint32 slot)
+{
+    if (position(score, slot) < 0)
+        return;
+
+    // Every node on the way down loses one descendant
+    int *link = &root;
+    while (*link >= 0) {
+        Node &n = nodes[*link];
+        if (n.score == score && n.slot == slot) {
+            int dead = *link;
+            *link = merge(n.left, n.right);
+            freeList.push_back(dead);
+            return;
+        }
+        n.size--;
+        link = before(score, slot, n.score, n.slot) ? &n.left : &n.right;
+    }
+}
+
+int RankIndex::countAbove(int score) const
+{
+    int count = 0;
+    int n = root;
+    while (n >= 0) {
+        const Node &node = nodes[n];
+        if (node.score > score) {
+            count += sizeOf(node.left) + 1;
+            n = node.right;
+        } else {
+            n = node.left;
+        }
+    }
+    return count;
+}
+
+int RankIndex::position(int score, quint32 slot) const
+{
+    int pos = 0;
+    int n = root;
+    while (n >= 0) {
+        const Node &node = nodes[n];
+        if (before(node.score, node.slot, score, slot)) {
+            pos += sizeOf(node.left) + 1;
+            n = node.right;
+        } else if (node.score == score && node.slot == slot) {
+            return pos + sizeOf(node.left);
+        } else {
+            n = node.left;
+        }
+    }
+    return -1;
+}
+
+void RankIndex::collect(int first, int count, QVector<quint32> &out) const
+{
+    if (first < 0) {
+        count += first;
+        first = 0;
+    }
+    if (count > 0)
+        collectFrom(root, first, count, out);
+}
+
+void RankIndex::collectFrom(int n, int first, int count, QVector<quint32> &out) const
+{
+    // In-order walk that skips whole subtrees left of `first`
+    while (n >= 0 && count > 0) {
+        const Node &node = nodes[n];
+        int leftSize = sizeOf(node.left);
+
+        if (first < leftSize) {
+            int had = out.size();
+            collectFrom(node.left, first, count, out);
+            count -= out.size() - had;
+            first = 0;
+        } else {
+            first -= leftSize;
+        }
+
+        if (count <= 0)
+            return;
+        if (first == 0) {
+            out.append(node.slot);
+            --count;
+        } else {
+            --first;
+        }
+        n = node.right;
+    }
+}
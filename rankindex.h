@@ -0,0 +1,62 @@
+#ifndef RANKINDEX_H
+#define RANKINDEX_H
+
+#include <QVector>
+#include <QtGlobal>
+#include <vector>
+
+// ======================================================
+// Order-statistics index over (score desc, slot asc)
+//
+// Treap with subtree sizes, nodes live in one flat vector and
+// link by index. Insert, erase and rank are O(log n), reading
+// N consecutive ranks is O(log n + N).
+// ======================================================
+class RankIndex
+{
+public:
+    RankIndex();
+
+    void reserve(int n);
+    void clear();
+    int size() const { return root < 0 ? 0 : nodes[root].size; }
+
+    void insert(int score, quint32 slot);
+    void erase(int score, quint32 slot);
+
+    // Entries with a strictly higher score (so rank = this + 1)
+    int countAbove(int score) const;
+    // 0-based position of (score, slot) in the ordering
+    int position(int score, quint32 slot) const;
+    // Slots at positions [first, first + count)
+    void collect(int first, int count, QVector<quint32> &out) const;
+
+private:
+    struct Node {
+        int score;
+        quint32 slot;
+        quint32 priority;
+        int left;
+        int right;
+        int size;
+    };
+
+    static bool before(int scoreA, quint32 slotA, int scoreB, quint32 slotB)
+    {
+        return scoreA != scoreB ? scoreA > scoreB : slotA < slotB;
+    }
+
+    int sizeOf(int n) const { return n < 0 ? 0 : nodes[n].size; }
+    void update(int n) { nodes[n].size = 1 + sizeOf(nodes[n].left) + sizeOf(nodes[n].right); }
+    void split(int n, int score, quint32 slot, int &left, int &right);
+    int merge(int left, int right);
+    int allocNode(int score, quint32 slot);
+    void collectFrom(int n, int first, int count, QVector<quint32> &out) const;
+
+    std::vector<Node> nodes;
+    std::vector<int> freeList;
+    int root = -1;
+    quint32 seed = 0x9E3779B9u;
+};
+
+#endif // RANKINDEX_H
@@ -0,0 +1,462 @@
+#include "simsnapshot.h"
+
+#include <QDebug>
+#include <cstring>
+#include <type_traits>
+
+static const char kMagic[4] = { 'E', 'G', 'G', 'S' };
+
+// Bounds a corrupt file cannot push allocations past
+static const quint32 kMaxRecords = 1u << 20;
+
+// Record sizes as written, field by field (no padding bytes,
+// which would differ from step to step and spoil the deltas)
+static const int kEggBytes = 16 + 4 + 4 + 1 + 4 + 4 + 4 + 1;
+static const int kParticleBytes = 8 + 8 + 4 + 2 + 1;
+static const int kWindParticleBytes = 16 + 16 + 4 + 4;
+static const int kWindStreakBytes = 16 + 4 + 4;
+static const int kFixedBytes = 256;     // header and scalars, with room
+
+/* -------------------------------------------------------------
+   Raw little helpers; the buffer is sized before writing
+--------------------------------------------------------------*/
+namespace {
+
+struct Writer {
+    char *p;
+
+    template <typename T>
+    void put(T v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+        std::memcpy(p, &v, sizeof(T));
+        p += sizeof(T);
+    }
+    void put(bool v) { put(quint8(v)); }
+    void put(QPointF v) { put(double(v.x())); put(double(v.y())); }
+    void put(QPoint v) { put(qint32(v.x())); put(qint32(v.y())); }
+};
+
+struct Reader {
+    const char *p;
+    const char *end;
+    bool ok = true;
+
+    template <typename T>
+    T get()
+    {
+        T v{};
+        if (end - p < qptrdiff(sizeof(T))) {
+            ok = false;
+            p = end;
+            return v;
+        }
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+    bool flag() { return get<quint8>() != 0; }
+    QPointF pointF()
+    {
+        double x = get<double>();
+        return QPointF(x, get<double>());
+    }
+    QPoint point()
+    {
+        qint32 x = get<qint32>();
+        return QPoint(x, get<qint32>());
+    }
+    // A count whose records must still fit in the data
+    quint32 count(int recordBytes)
+    {
+        quint32 n = get<quint32>();
+        if (n > kMaxRecords || qint64(n) * recordBytes > end - p)
+            ok = false;
+        return ok ? n : 0;
+    }
+};
+
+} // namespace
+
+static void putRing(Writer &w, const ParticleRing<Particle> &ring)
+{
+    w.put(quint32(ring.budget()));
+    w.put(qint32(ring.oldest()));
+    w.put(qint32(ring.used()));
+    for (const Particle &p : ring.slotData()) {
+        w.put(p.origin);
+        w.put(p.velocity);
+        w.put(p.born);
+        w.put(p.life);
+        w.put(p.palette);
+    }
+}
+
+static void putRing(Writer &w, const ParticleRing<WindParticle> &ring)
+{
+    w.put(quint32(ring.budget()));
+    w.put(qint32(ring.oldest()));
+    w.put(qint32(ring.used()));
+    for (const WindParticle &wp : ring.slotData()) {
+        w.put(wp.origin);
+        w.put(wp.vel);
+        w.put(wp.maxLife);
+        w.put(wp.born);
+    }
+}
+
+static void putRing(Writer &w, const ParticleRing<WindStreak> &ring)
+{
+    w.put(quint32(ring.budget()));
+    w.put(qint32(ring.oldest()));
+    w.put(qint32(ring.used()));
+    for (const WindStreak &ws : ring.slotData()) {
+        w.put(ws.pos);
+        w.put(ws.maxLife);
+        w.put(ws.born);
+    }
+}
+
+template <typename T, typename ReadRecord>
+static bool getRing(Reader &r, ParticleRing<T> &ring, int recordBytes, ReadRecord &&readRecord)
+{
+    quint32 budget = r.count(recordBytes);
+    qint32 oldest = r.get<qint32>();
+    qint32 used = r.get<qint32>();
+    if (!r.ok)
+        return false;
+    // Checks again now the offsets have been read
+    if (qint64(budget) * recordBytes > r.end - r.p)
+        return false;
+
+    std::vector<T> slots(budget);
+    for (T &slot : slots)
+        readRecord(slot);
+    return r.ok && ring.restore(std::move(slots), oldest, used);
+}
+
+/* -------------------------------------------------------------
+   Save / load
+--------------------------------------------------------------*/
+void SimSnapshot::save(const GameSimulation &sim, QByteArray &out)
+{
+    const qint64 maxBytes = kFixedBytes
+        + 4 + 4 * qint64(sim.dropColumns.size())
+        + 4 + kEggBytes * qint64(sim.eggs.size())
+        + 12 + kParticleBytes * qint64(sim.particles.budget())
+        + 12 + kWindParticleBytes * qint64(sim.windParticles.budget())
+        + 12 + kWindStreakBytes * qint64(sim.windStreaks.budget())
+        + 4;
+    out.resize(int(maxBytes));
+    Writer w{ out.data() };
+
+    for (char c : kMagic)
+        w.put(c);
+    w.put(kVersion);
+    w.put(quint16(0));
+
+    // ---- Scalars ----
+    w.put(qint32(sim.cols));
+    w.put(qint32(sim.rows));
+    w.put(sim.stepCount);
+    w.put(sim.rng.state);
+
+    w.put(sim.basket);
+    w.put(sim.prevBasketX);
+    w.put(sim.basketXVelocity);
+    w.put(sim.basketTargetVel);
+    w.put(sim.basketAccel);
+    w.put(sim.basketMaxVel);
+    w.put(sim.fixedDelta);
+
+    w.put(sim.globalTime);
+    w.put(sim.globalSpawnTimer);
+    w.put(sim.spawnInterval);
+    w.put(sim.lastEdgeSpawnTime);
+    w.put(sim.edgeSpawnCooldown);
+    w.put(qint32(sim.currentColumnIndex));
+
+    w.put(qint32(sim.score));
+    w.put(qint32(sim.lives));
+    w.put(qint32(sim.highScore));
+
+    w.put(sim.flashAlpha);
+    w.put(sim.flashColor.isValid());
+    w.put(quint64(sim.flashColor.isValid() ? sim.flashColor.rgba64() : QRgba64()));
+    w.put(sim.flashTimer);
+    w.put(sim.scoreScale);
+    w.put(sim.scoreAnimTimer);
+    w.put(sim.livesPulseTimer);
+
+    w.put(sim.windActive);
+    w.put(sim.windStrength);
+    w.put(sim.windTimer);
+    w.put(sim.windCooldown);
+    w.put(sim.timeSinceLastWind);
+    w.put(sim.focusMode);
+
+    // ---- Fixed-size rings before anything that changes length ----
+    putRing(w, sim.particles);
+    putRing(w, sim.windParticles);
+    putRing(w, sim.windStreaks);
+
+    w.put(quint32(sim.dropColumns.size()));
+    for (int col : sim.dropColumns)
+        w.put(qint32(col));
+
+    w.put(quint32(sim.eggs.size()));
+    for (const Egg &egg : sim.eggs) {
+        w.put(egg.pos);
+        w.put(egg.prevY);
+        w.put(egg.yVelocity);
+        w.put(quint8(egg.state));
+        w.put(egg.animTimer);
+        w.put(egg.scale);
+        w.put(egg.alpha);
+        w.put(quint8(egg.type));
+    }
+
+    // Whole words, for the rewind deltas
+    int size = int(w.p - out.constData());
+    int padded = (size + 3) & ~3;
+    std::memset(w.p, 0, padded - size);
+    out.resize(padded);
+}
+
+QByteArray SimSnapshot::save(const GameSimulation &sim)
+{
+    QByteArray out;
+    save(sim, out);
+    return out;
+}
+
+bool SimSnapshot::load(GameSimulation &sim, const QByteArray &data)
+{
+    Reader r{ data.constData(), data.constData() + data.size() };
+
+    char magic[4];
+    for (char &c : magic)
+        c = r.get<char>();
+    quint16 version = r.get<quint16>();
+    r.get<quint16>();
+    if (!r.ok || std::memcmp(magic, kMagic, 4) != 0 || version != kVersion) {
+        qDebug() << "SNAPSHOT: not a version" << kVersion << "save state";
+        return false;
+    }
+
+    GameSimulation next = sim;
+
+    next.cols = r.get<qint32>();
+    next.rows = r.get<qint32>();
+    next.stepCount = r.get<quint32>();
+    next.rng.state = r.get<quint64>();
+
+    next.basket = r.pointF();
+    next.prevBasketX = r.get<float>();
+    next.basketXVelocity = r.get<float>();
+    next.basketTargetVel = r.get<float>();
+    next.basketAccel = r.get<float>();
+    next.basketMaxVel = r.get<float>();
+    next.fixedDelta = r.get<float>();
+
+    next.globalTime = r.get<float>();
+    next.globalSpawnTimer = r.get<float>();
+    next.spawnInterval = r.get<float>();
+    next.lastEdgeSpawnTime = r.get<float>();
+    next.edgeSpawnCooldown = r.get<float>();
+    next.currentColumnIndex = r.get<qint32>();
+
+    next.score = r.get<qint32>();
+    next.lives = r.get<qint32>();
+    next.highScore = r.get<qint32>();
+
+    next.flashAlpha = r.get<float>();
+    bool flashValid = r.flag();
+    QRgba64 flash = QRgba64::fromRgba64(r.get<quint64>());
+    next.flashColor = flashValid ? QColor::fromRgba64(flash) : QColor();
+    next.flashTimer = r.get<float>();
+    next.scoreScale = r.get<float>();
+    next.scoreAnimTimer = r.get<float>();
+    next.livesPulseTimer = r.get<float>();
+
+    next.windActive = r.flag();
+    next.windStrength = r.get<float>();
+    next.windTimer = r.get<float>();
+    next.windCooldown = r.get<float>();
+    next.timeSinceLastWind = r.get<float>();
+    next.focusMode = r.flag();
+
+    bool ok = r.ok;
+    ok = ok && getRing(r, next.particles, kParticleBytes, [&r](Particle &p) {
+        p.origin = r.point();
+        p.velocity = r.point();
+        p.born = r.get<quint32>();
+        p.life = r.get<qint16>();
+        p.palette = r.get<quint8>();
+        if (p.palette >= quint8(EggType::Count))
+            r.ok = false;
+    });
+    ok = ok && getRing(r, next.windParticles, kWindParticleBytes, [&r](WindParticle &wp) {
+        wp.origin = r.pointF();
+        wp.vel = r.pointF();
+        wp.maxLife = r.get<float>();
+        wp.born = r.get<quint32>();
+    });
+    ok = ok && getRing(r, next.windStreaks, kWindStreakBytes, [&r](WindStreak &ws) {
+        ws.pos = r.pointF();
+        ws.maxLife = r.get<float>();
+        ws.born = r.get<quint32>();
+    });
+
+    if (ok) {
+        next.dropColumns.resize(int(r.count(4)));
+        for (int &col : next.dropColumns)
+            col = r.get<qint32>();
+
+        next.eggs.resize(int(r.count(kEggBytes)));
+        for (Egg &egg : next.eggs) {
+            egg.pos = r.pointF();
+            egg.prevY = r.get<float>();
+            egg.yVelocity = r.get<float>();
+            egg.state = EggState(r.get<quint8>());
+            egg.animTimer = r.get<float>();
+            egg.scale = r.get<float>();
+            egg.alpha = r.get<float>();
+            egg.type = EggType(r.get<quint8>());
+            if (quint8(egg.state) > quint8(EggState::Splat) || egg.type >= EggType::Count)
+                r.ok = false;
+        }
+        ok = r.ok && !next.dropColumns.isEmpty()
+             && next.currentColumnIndex >= 0 && next.currentColumnIndex < next.dropColumns.size();
+    }
+
+    if (!ok) {
+        qDebug() << "SNAPSHOT: damaged save state";
+        return false;
+    }
+    sim = std::move(next);
+    return true;
+}
+
+/* -------------------------------------------------------------
+   Deltas: word-wise XOR of `to` against `from` (zero past
+   from's end) as runs of
+       u32 zero words, u32 literal words, literal words...
+   after a u32 byte size of `to`
+--------------------------------------------------------------*/
+void SimSnapshot::encodeDelta(const QByteArray &from, const QByteArray &to, QByteArray &out)
+{
+    const int words = to.size() / 4;
+    const int fromWords = from.size() / 4;
+    const quint32 *a = reinterpret_cast<const quint32 *>(from.constData());
+    const quint32 *b = reinterpret_cast<const quint32 *>(to.constData());
+
+    // Worst case: every word literal, or one header per three words
+    if (out.size() < 12 + words * 8)
+        out.resize(12 + words * 8);
+    quint32 *o = reinterpret_cast<quint32 *>(out.data());
+    *o++ = quint32(to.size());
+
+    auto diff = [&](int i) { return b[i] ^ (i < fromWords ? a[i] : 0u); };
+
+    int i = 0;
+    while (i < words) {
+        quint32 zeros = 0;
+        while (i < words && diff(i) == 0) {
+            ++zeros;
+            ++i;
+        }
+        quint32 *literalCount = o + 1;
+        *o = zeros;
+        o += 2;
+        quint32 literals = 0;
+        // A lone zero word stays in the literal run; two end it
+        while (i < words && (diff(i) != 0 || (i + 1 < words && diff(i + 1) != 0))) {
+            *o++ = diff(i);
+            ++literals;
+            ++i;
+        }
+        *literalCount = literals;
+    }
+    out.resize(int(reinterpret_cast<char *>(o) - out.constData()));
+}
+
+bool SimSnapshot::applyDelta(const QByteArray &from, const QByteArray &delta, QByteArray &to)
+{
+    const quint32 *d = reinterpret_cast<const quint32 *>(delta.constData());
+    const quint32 *end = d + delta.size() / 4;
+    if (d == end)
+        return false;
+
+    const int size = int(*d++);
+    const int words = size / 4;
+    const int fromWords = from.size() / 4;
+    const quint32 *a = reinterpret_cast<const quint32 *>(from.constData());
+    to.resize(size);
+    quint32 *b = reinterpret_cast<quint32 *>(to.data());
+
+    int i = 0;
+    while (d + 2 <= end) {
+        quint32 zeros = *d++;
+        quint32 literals = *d++;
+        if (zeros + literals > quint32(words - i) || literals > quint32(end - d))
+            return false;
+        for (quint32 k = 0; k < zeros; ++k, ++i)
+            b[i] = i < fromWords ? a[i] : 0u;
+        for (quint32 k = 0; k < literals; ++k, ++i)
+            b[i] = *d++ ^ (i < fromWords ? a[i] : 0u);
+    }
+    return i == words;
+}
+
+/* -------------------------------------------------------------
+   Rewind buffer
+--------------------------------------------------------------*/
+RewindBuffer::RewindBuffer(int maxSteps, qint64 maxBytes)
+    : maxSteps(maxSteps),
+    maxBytes(maxBytes)
+{
+}
+
+void RewindBuffer::clear()
+{
+    latest.clear();
+    deltas.clear();
+    deltaBytes = 0;
+}
+
+void RewindBuffer::push(const GameSimulation &sim)
+{
+    SimSnapshot::save(sim, scratch);
+    if (!latest.isEmpty()) {
+        // What turns the new snapshot back into the previous one
+        SimSnapshot::encodeDelta(scratch, latest, encodeBuffer);
+        deltas.emplace_back(encodeBuffer.constData(), encodeBuffer.size());
+        deltaBytes += encodeBuffer.size();
+    }
+    latest.swap(scratch);
+
+    while (!deltas.empty() && (int(deltas.size()) > maxSteps || bytes() > maxBytes)) {
+        deltaBytes -= deltas.front().size();
+        deltas.pop_front();
+    }
+}
+
+bool RewindBuffer::rewind(int count, GameSimulation &sim)
+{
+    count = qMin(count, steps());
+    if (count <= 0)
+        return false;
+
+    for (int i = 0; i < count; ++i) {
+        if (!SimSnapshot::applyDelta(latest, deltas.back(), scratch)) {
+            qDebug() << "REWIND: damaged delta, history dropped";
+            clear();
+            return false;
+        }
+        latest.swap(scratch);
+        deltaBytes -= deltas.back().size();
+        deltas.pop_back();
+    }
+    return SimSnapshot::load(sim, latest);
+}
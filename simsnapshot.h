@@ -0,0 +1,74 @@
+#ifndef SIMSNAPSHOT_H
+#define SIMSNAPSHOT_H
+
+#include <QByteArray>
+#include <deque>
+
+#include "gamesim.h"
+
+// ======================================================
+// Save states: all of a GameSimulation's state as bytes,
+// behind a magic and a version. The callbacks and the keys
+// held right now (steer) belong to whoever drives the
+// simulation, so loading keeps the target's own.
+//
+// Fixed-size parts come first and the particle rings are
+// written slot by slot, so two snapshots a step apart line
+// up byte for byte and differ only where the game moved.
+// ======================================================
+namespace SimSnapshot
+{
+constexpr quint16 kVersion = 1;
+
+// Overwrites `out`; a reused buffer does not reallocate
+void save(const GameSimulation &sim, QByteArray &out);
+QByteArray save(const GameSimulation &sim);
+
+// False, leaving sim untouched, on a wrong magic or version or
+// on truncated data
+bool load(GameSimulation &sim, const QByteArray &data);
+
+// Word-wise XOR of `to` against `from`, runs of zero words
+// coded by length; `out` is overwritten and can be reused
+void encodeDelta(const QByteArray &from, const QByteArray &to, QByteArray &out);
+// False on a damaged delta
+bool applyDelta(const QByteArray &from, const QByteArray &delta, QByteArray &to);
+}
+
+// ======================================================
+// Rewind: one snapshot per fixed step for the last few
+// seconds. Only the newest is kept whole; each older one is
+// stored as the XOR against the one after it, run-length
+// coded over zero words, which is small because a step
+// touches little of the state. Rewinding walks the deltas
+// back from the newest. The oldest steps are dropped past
+// maxSteps or maxBytes.
+// ======================================================
+class RewindBuffer
+{
+public:
+    explicit RewindBuffer(int maxSteps = 1200, qint64 maxBytes = 5 * 1024 * 1024);
+
+    void clear();
+    // After every fixed step
+    void push(const GameSimulation &sim);
+
+    // Steps that can be rewound
+    int steps() const { return int(deltas.size()); }
+    qint64 bytes() const { return latest.size() + deltaBytes; }
+
+    // Loads the state from `count` steps ago (at most steps())
+    // into sim and forgets everything after it
+    bool rewind(int count, GameSimulation &sim);
+
+private:
+    int maxSteps;
+    qint64 maxBytes;
+    QByteArray latest;               // newest snapshot, whole
+    QByteArray scratch;              // next snapshot / decode buffer
+    QByteArray encodeBuffer;
+    std::deque<QByteArray> deltas;   // back() turns latest into the step before
+    qint64 deltaBytes = 0;
+};
+
+#endif // SIMSNAPSHOT_H
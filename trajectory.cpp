@@ -0,0 +1,364 @@
+#include "trajectory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+FallModel Trajectory::model(const GameSimulation &sim, EggType type)
+{
+    // Same float expressions as updateEggs
+    const bool focus = sim.focusMode;
+    const float baseGravity = (10.0f + sim.score * 0.05f)
+        * (focus ? ModeTraits<true>::gravityScale : ModeTraits<false>::gravityScale);
+    const float maxFallSpeed = 22.0f * (focus ? ModeTraits<true>::fallSpeedScale : ModeTraits<false>::fallSpeedScale);
+    const float dt = sim.fixedDelta;
+
+    FallModel m;
+    m.accel = baseGravity * eggTraits(type).gravityScale * dt;
+    m.cap = maxFallSpeed;
+    m.dt = dt;
+    return m;
+}
+
+// Steps whose velocity is still below the cap
+static int freeSteps(const FallModel &m, double v)
+{
+    if (v >= m.cap)
+        return 0;
+    return int(std::ceil((m.cap - v) / m.accel)) - 1;
+}
+
+double Trajectory::velocityAfter(const FallModel &m, double v, int steps)
+{
+    return std::min(v + steps * m.accel, m.cap);
+}
+
+double Trajectory::yAfter(const FallModel &m, double y, double v, int steps)
+{
+    const int free = std::min(freeSteps(m, v), steps);
+    y += m.dt * (free * v + 0.5 * m.accel * free * (free + 1.0));
+    return y + m.dt * m.cap * (steps - free);
+}
+
+double Trajectory::xAfter(double x, double drift, int windSteps, int steps, double maxX)
+{
+    // One direction per gust, so clamping once is clamping every step
+    return std::clamp(x + drift * std::min(steps, windSteps), 0.0, maxX);
+}
+
+int Trajectory::stepsToRow(const FallModel &m, double y, double v, double row, bool inclusive, double *clearance)
+{
+    auto past = [&](double at) { return inclusive ? at >= row : at > row; };
+
+    // accel/2 k^2 + (v + accel/2) k = velocity sum needed, while uncapped
+    const int free = freeSteps(m, v);
+    const double need = std::max(0.0, (row - y) / m.dt);
+    const double b = std::min(v, m.cap) + 0.5 * m.accel;
+    const double root = (std::sqrt(b * b + 2.0 * m.accel * need) - b) / m.accel;
+    int k;
+    if (root <= free)
+        k = int(std::ceil(root));
+    else
+        k = free + int(std::ceil((row - yAfter(m, y, v, free)) / (m.cap * m.dt)));
+
+    // The root is within rounding of the answer
+    k = std::max(k, 1);
+    double before = yAfter(m, y, v, k - 1);
+    while (k > 1 && past(before))
+        before = yAfter(m, y, v, --k - 1);
+    double at = yAfter(m, y, v, k);
+    while (!past(at)) {
+        before = at;
+        at = yAfter(m, y, v, ++k);
+    }
+    if (clearance)
+        *clearance = k > 1 ? std::min(row - before, at - row) : at - row;
+    return k;
+}
+
+int Trajectory::windSteps(const GameSimulation &sim)
+{
+    if (!sim.windActive)
+        return 0;
+    // The steps after which the countdown is still above 0
+    return stepsUntil(sim.windTimer, -sim.fixedDelta, 0.0f) - 1;
+}
+
+/* -------------------------------------------------------------
+   TIMERS
+--------------------------------------------------------------*/
+// 2^e for the exponents a float has
+static inline double powerOfTwo(int e)
+{
+    const quint64 bits = quint64(1023 + e) << 52;
+    double p;
+    std::memcpy(&p, &bits, sizeof p);
+    return p;
+}
+
+float Trajectory::timerAfter(float t, float d, int steps)
+{
+    while (steps > 0) {
+        // |t| in [lo, 2 lo), where floats are u apart: while t + d stays
+        // there too, every step rounds d to the same multiple of u
+        // (unless d is an exact half-multiple, when ties alternate)
+        quint32 bits;
+        std::memcpy(&bits, &t, sizeof bits);
+        const int exponent = int((bits >> 23) & 0xff);
+        if (exponent != 0 && exponent != 0xff) {
+            const double a = std::abs(double(t));
+            const double away = t < 0.0f ? -double(d) : double(d);
+            const double lo = powerOfTwo(exponent - 127);
+            const double perU = powerOfTwo(150 - exponent);     // 1 / u, u = lo / 2^23
+            const double twice = 2.0 * away * perU;             // exact: a power of two apart
+            if (std::abs(twice) < 1.0 && (away >= 0.0 || a > lo))
+                return t;               // t + d rounds back to t, every time
+            const qint64 whole = std::abs(twice) < 0x1p52 ? qint64(twice) : 0;
+            if (whole != 0 && (double(whole) != twice || (whole & 1) == 0)) {
+                // Nearest multiple of u, not a tie
+                const double inc = double((whole + (whole >= 0 ? 1 : -1)) / 2) / perU;
+                auto stays = [&](double i) {
+                    const double r = a + i * inc + away;
+                    return r >= lo && r < 2.0 * lo;
+                };
+                double n = inc > 0.0 ? std::ceil((2.0 * lo - a - away) / inc)
+                                     : std::floor((a + away - lo) / -inc) + 1.0;
+                n = std::clamp(n, 0.0, double(steps));
+                while (n > 0.0 && !stays(n - 1.0))
+                    n -= 1.0;
+                while (n < steps && stays(n))
+                    n += 1.0;
+                if (n > 0.0) {
+                    const double jumped = a + n * inc;     // exact: on the grid
+                    t = float(t < 0.0f ? -jumped : jumped);
+                    steps -= int(n);
+                    continue;
+                }
+            }
+        }
+        // Across a power of two, near 0 or on a tie: one step as it is
+        t += d;
+        --steps;
+    }
+    return t;
+}
+
+int Trajectory::stepsUntil(float t, float d, float limit, int most)
+{
+    auto reached = [&](float at) { return d > 0.0f ? at >= limit : at <= limit; };
+    if (d == 0.0f)
+        return reached(t) ? 1 : most;
+
+    // The exact answer is within rounding of the real one: jump to
+    // just before it, then step
+    const double guess = std::ceil((double(limit) - double(t)) / double(d));
+    int k = int(std::clamp(guess, 1.0, double(most)));
+    float before = timerAfter(t, d, k - 1);
+    while (k > 1 && reached(before))
+        before = timerAfter(t, d, --k - 1);
+    for (float at = before + d; k < most && !reached(at); at += d)
+        ++k;
+    return k;
+}
+
+/* -------------------------------------------------------------
+   BASKET
+--------------------------------------------------------------*/
+namespace {
+
+// glideBasket's step, in doubles: v += (target - v) * b, x += v * h
+struct Glide {
+    double q = 0.0;             // 1 - b, the velocity kept
+    double b = 0.0;
+    double h = 0.0;
+    double maxV = 0.0;
+    double maxX = 0.0;
+    bool pointer = false;       // proportional toward p, held to +-maxV
+    double p = 0.0;
+    double g = 0.0;
+    double keys = 0.0;          // the target when not the pointer's
+    double x = 0.0;
+    double v = 0.0;
+
+    double target(double at) const
+    {
+        return pointer ? std::clamp((p - at) * g, -maxV, maxV) : keys;
+    }
+};
+
+// First k in [lo, hi] with pred(k), pred false then true; hi + 1 if none
+template <typename Pred>
+int firstTrue(int lo, int hi, Pred pred)
+{
+    ++hi;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (pred(mid))
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return lo;
+}
+
+// Target T held: v_k = T + (v - T) q^k, and x gains h times their sum.
+// Jumps to where T stops holding or a wall is met, at most `steps`.
+int constantTarget(Glide &s, int steps)
+{
+    const double T = s.target(s.x);
+    const double dv = s.v - T;
+    auto vAt = [&](int k) { return T + dv * std::pow(s.q, k); };
+    auto xAt = [&](int k) { return s.x + s.h * (k * T + dv * s.q * (1.0 - std::pow(s.q, k)) / s.b); };
+
+    // Against a wall and pushing into it: x stays until v turns
+    const double wall = s.x <= 0.0 ? 0.0 : (s.x >= s.maxX ? s.maxX : -1.0);
+    if (wall >= 0.0) {
+        const double out = wall == 0.0 ? 1.0 : -1.0;
+        if (vAt(1) * out <= 0.0) {
+            const int pinned = firstTrue(1, steps, [&](int k) { return vAt(k) * out > 0.0; }) - 1;
+            s.v = vAt(pinned);
+            return pinned;
+        }
+    }
+
+    // The positions T holds for: the field, and for the pointer the
+    // side of it far enough away to ask full speed
+    double lo = 0.0;
+    double hi = s.maxX;
+    if (s.pointer && T > 0.0)
+        hi = std::min(hi, s.p - s.maxV / s.g);
+    else if (s.pointer && T < 0.0)
+        lo = std::max(lo, s.p + s.maxV / s.g);
+    auto outside = [&](int k) {
+        const double at = xAt(k);
+        return at < lo || at > hi;
+    };
+
+    // v only moves toward T, so x turns at most once: out of the
+    // interval is a search on each side of the turn
+    const double first = vAt(1);
+    const int turn = first == 0.0 ? 1 : firstTrue(1, steps, [&](int k) { return vAt(k) * first <= 0.0; });
+    int exit = firstTrue(1, std::min(turn - 1, steps), outside);
+    if (exit > std::min(turn - 1, steps) && turn <= steps)
+        exit = firstTrue(turn, steps, outside);
+    const int n = std::min(exit, steps);
+    s.x = std::clamp(xAt(n), 0.0, s.maxX);
+    s.v = vAt(n);
+    return n;
+}
+
+// Pointer close: e = (x - p, v) is multiplied by a fixed 2x2 matrix
+// each step. Jumped only when its envelope shows it stays close and
+// off the walls from here on.
+int nearPointer(Glide &s, int steps)
+{
+    const double gb = s.g * s.b;
+    const double a11 = 1.0 - s.h * gb, a12 = s.h * s.q, a21 = -gb, a22 = s.q;
+    const double ex = s.x - s.p;
+    const double ex1 = a11 * ex + a12 * s.v;
+
+    // e_x after k steps is c1 l1^k + c2 l2^k, or Re(c l^k) for a
+    // complex pair; with |l| < 1 it never exceeds |c1| + |c2| or |c|
+    const double tr = a11 + a22;
+    const double det = a11 * a22 - a12 * a21;
+    const double disc = tr * tr - 4.0 * det;
+    double reach = std::numeric_limits<double>::infinity();
+    if (disc < 0.0 && det < 1.0) {
+        const double re = 0.5 * tr;
+        const double im = 0.5 * std::sqrt(-disc);
+        reach = std::hypot(ex, (ex * re - ex1) / im);
+    } else if (disc > 0.0) {
+        const double l1 = 0.5 * (tr + std::sqrt(disc));
+        const double l2 = 0.5 * (tr - std::sqrt(disc));
+        if (std::abs(l1) < 1.0 && std::abs(l2) < 1.0) {
+            const double c1 = (ex1 - l2 * ex) / (l1 - l2);
+            reach = std::abs(c1) + std::abs(ex - c1);
+        }
+    }
+    // Within float rounding of the pointer counts as there
+    const double settled = 1e-6;
+    if (reach * s.g >= s.maxV || s.p - reach < -settled || s.p + reach > s.maxX + settled)
+        return 0;
+
+    // A^steps by squaring
+    double m11 = 1.0, m12 = 0.0, m21 = 0.0, m22 = 1.0;
+    double p11 = a11, p12 = a12, p21 = a21, p22 = a22;
+    for (int n = steps; n; n >>= 1) {
+        if (n & 1) {
+            const double r11 = m11 * p11 + m12 * p21, r12 = m11 * p12 + m12 * p22;
+            const double r21 = m21 * p11 + m22 * p21, r22 = m21 * p12 + m22 * p22;
+            m11 = r11; m12 = r12; m21 = r21; m22 = r22;
+        }
+        const double r11 = p11 * p11 + p12 * p21, r12 = p11 * p12 + p12 * p22;
+        const double r21 = p21 * p11 + p22 * p21, r22 = p21 * p12 + p22 * p22;
+        p11 = r11; p12 = r12; p21 = r21; p22 = r22;
+    }
+    s.x = std::clamp(s.p + m11 * ex + m12 * s.v, 0.0, s.maxX);
+    s.v = m21 * ex + m22 * s.v;
+    return steps;
+}
+
+}
+
+BasketGlide Trajectory::glide(const GameSimulation &sim, int steps)
+{
+    // Same floats as integrateBasket for a whole fixed step
+    const float keep = 1.0f - qMin(1.0f, sim.fixedDelta * sim.basketAccel);
+    Glide s;
+    s.q = keep;
+    s.b = 1.0f - keep;
+    s.h = sim.fixedDelta;
+    s.maxV = sim.basketMaxVel;
+    s.maxX = sim.cols - 1;
+    const bool leftHeld = sim.steer.holding(InputAction::Left);
+    const bool rightHeld = sim.steer.holding(InputAction::Right);
+    s.pointer = leftHeld == rightHeld && !leftHeld && sim.steer.pointerHeld();
+    s.p = sim.steer.pointerColumn();
+    s.g = SteerState::kPointerGain;
+    s.keys = leftHeld == rightHeld ? 0.0 : (leftHeld ? -s.maxV : s.maxV);
+    s.x = sim.basket.x();
+    s.v = sim.basketXVelocity;
+
+    // A few cases one after the other: full speed, then close in
+    BasketGlide glided;
+    for (int part = 0; part < 4 && glided.steps < steps && s.b > 0.0; ++part) {
+        const int left = steps - glided.steps;
+        const int n = s.pointer && std::abs((s.p - s.x) * s.g) < s.maxV ? nearPointer(s, left)
+                                                                         : constantTarget(s, left);
+        if (n == 0)
+            break;
+        glided.steps += n;
+    }
+    glided.x = float(s.x);
+    glided.velocity = float(s.v);
+    return glided;
+}
+
+Landing Trajectory::land(const GameSimulation &sim, const Egg &egg)
+{
+    return land(sim, egg, windSteps(sim));
+}
+
+Landing Trajectory::land(const GameSimulation &sim, const Egg &egg, int wind)
+{
+    const FallModel m = model(sim, egg.type);
+    const double y = egg.pos.y();
+    const double v = egg.yVelocity;
+    const float drift = sim.windActive ? sim.windStrength * sim.fixedDelta : 0.0f;
+    const double maxX = sim.cols - 1;
+
+    // Catch box top as in updateEggs: the egg's bottom past half a
+    // cell above the basket; splat on the last row
+    Landing landing;
+    const double reachRow = sim.basket.y() - 1.5;
+    double reachClearance = 0.0;
+    double splatClearance = 0.0;
+    landing.reachStep = stepsToRow(m, y, v, reachRow, false, &reachClearance);
+    landing.splatStep = stepsToRow(m, y, v, sim.rows - 1, true, &splatClearance);
+    landing.reachClear = reachClearance > kRounding;
+    landing.splatClear = splatClearance > kRounding;
+    landing.reachX = xAfter(egg.pos.x(), drift, wind, landing.reachStep, maxX);
+    landing.splatX = xAfter(egg.pos.x(), drift, wind, landing.splatStep, maxX);
+    return landing;
+}
@@ -0,0 +1,88 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include "gamesim.h"
+
+// ======================================================
+// Egg flight in closed form
+//
+// updateEggs moves a falling egg one fixed step at a time:
+// yVelocity gains gravity * dt and is held at the fall speed
+// cap, then y moves by yVelocity * dt. Summed over the steps
+// that is a quadratic in the step count until the cap and a
+// straight line after it, and wind drifts x by the same amount
+// every step of a gust, clamped to the field. Gravity and the
+// cap only change with the score, so between catches the step
+// an egg reaches a row, and where it is then, follow directly.
+//
+// The game adds in floats and these sum in doubles: a result
+// can be one step off when the egg crosses the row within
+// rounding of a step boundary. land() says when a crossing is
+// clear of that; otherwise callers that must not miss the step
+// plan for the one before.
+// ======================================================
+struct FallModel {
+    double accel = 0.0;     // yVelocity gained per step
+    double cap = 0.0;       // fall speed cap
+    double dt = 0.0;
+};
+
+struct Landing {
+    int reachStep = 0;      // first step it can touch the basket
+    int splatStep = 0;      // step it hits the ground, unless caught
+    double reachX = 0.0;
+    double splatX = 0.0;
+    // Crossed by more than kRounding either side of the step: not off by one
+    bool reachClear = false;
+    bool splatClear = false;
+};
+
+struct BasketGlide {
+    int steps = 0;
+    float x = 0.0f;
+    float velocity = 0.0f;
+};
+
+namespace Trajectory
+{
+// Float steps and these sums drift apart by far less than this
+// over a flight, coasted or not (eggbench trajectory, fastforward)
+constexpr double kRounding = 1e-3;
+
+// For an egg of `type` at the simulation's score and mode
+FallModel model(const GameSimulation &sim, EggType type);
+
+double velocityAfter(const FallModel &m, double v, int steps);
+double yAfter(const FallModel &m, double y, double v, int steps);
+// Drift per step for the first windSteps steps, then none
+double xAfter(double x, double drift, int windSteps, int steps, double maxX);
+
+// First step (from 1) after which y is past `row`: y > row, or
+// y >= row when inclusive, as the catch and splat tests compare.
+// clearance: how far from the row the egg is the step before and
+// the step itself, the nearer
+int stepsToRow(const FallModel &m, double y, double v, double row, bool inclusive,
+               double *clearance = nullptr);
+
+// Coming steps the current gust still blows, counted in floats
+// the way step() counts its timer down
+int windSteps(const GameSimulation &sim);
+
+// `steps` times t += d, in floats, rounded as the steps round
+float timerAfter(float t, float d, int steps);
+// First step (from 1) after which such a timer has reached limit,
+// counting up (d > 0: t >= limit) or down (d < 0: t <= limit); at
+// most `most`
+int stepsUntil(float t, float d, float limit, int most = 1 << 30);
+
+// Where the basket is after up to `steps` steps under sim.steer;
+// `steps` says how many it could jump, 0 when the next one must be
+// stepped (the basket about to leave a case it can prove, say)
+BasketGlide glide(const GameSimulation &sim, int steps);
+
+Landing land(const GameSimulation &sim, const Egg &egg);
+// With windSteps(sim) already counted, for many eggs at once
+Landing land(const GameSimulation &sim, const Egg &egg, int windSteps);
+}
+
+#endif // TRAJECTORY_H